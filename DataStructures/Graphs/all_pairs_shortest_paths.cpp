@@ -0,0 +1,219 @@
+#include "all_pairs_shortest_paths.h"
+#include "../thread_pool.h"
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+
+AllPairsShortestPaths::AllPairsShortestPaths(const CSRGraph& graph, Method method, bool keepPaths,
+	size_t threads) {
+	build(graph, method, keepPaths, threads);
+}
+
+
+AllPairsShortestPaths::AllPairsShortestPaths(const Graph& graph, Method method, bool keepPaths,
+	size_t threads) {
+	CSRGraph* snapshot = graph.to_csr();
+	build(*snapshot, method, keepPaths, threads);
+	delete snapshot;
+}
+
+
+double AllPairsShortestPaths::query(uint32_t start, uint32_t end, std::vector<uint32_t>* path) const {
+
+	if (start >= count || end >= count) {
+		std::cerr << "Query not run: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	double weight = distance[start * stride + end];
+	if (!path) { return weight; }
+	if (previous.empty()) {
+		std::cerr << "Query not run: Paths were not kept." << std::endl;
+		throw std::invalid_argument("Paths were not kept.");
+	}
+
+	path->clear();
+	if (weight == INFINITY) { return weight; }
+	const uint32_t* row = &previous[start * stride];
+	for (uint32_t curr = end; curr != start; curr = row[curr]) {
+		path->push_back(curr);
+	}
+	path->push_back(start);
+	std::reverse(path->begin(), path->end());
+	return weight;
+}
+
+
+double AllPairsShortestPaths::query(const std::string& startId, const std::string& endId,
+	std::vector<std::string>* path) const {
+
+	uint32_t start = get_handle(startId), end = get_handle(endId);
+	if (start == NULL_HANDLE || end == NULL_HANDLE) {
+		std::cerr << "Query not run: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	if (!path) { return query(start, end); }
+	std::vector<uint32_t> handlePath;
+	double weight = query(start, end, &handlePath);
+	path->clear();
+	for (uint32_t handle : handlePath) {
+		path->push_back(ids[handle]);
+	}
+	return weight;
+}
+
+
+uint32_t AllPairsShortestPaths::get_handle(const std::string& id) const {
+	std::map<std::string, uint32_t>::const_iterator found = handles.find(id);
+	return found == handles.end() ? NULL_HANDLE : found->second;
+}
+
+
+std::string AllPairsShortestPaths::to_string() const {
+	std::stringstream ss;
+	ss << "__AllPairsShortestPaths__{id: " << graphId << ", count: " << count
+		<< ", paths: " << (previous.empty() ? "no" : "yes") << "}";
+	return ss.str();
+}
+
+
+void AllPairsShortestPaths::build(const CSRGraph& graph, Method method, bool keepPaths, size_t threads) {
+
+	graphId = graph.graphId;
+	count = graph.count;
+	ids = graph.ids;
+	handles.clear();
+	for (uint32_t i = 0; i < count; i++) {
+		handles.emplace(ids[i], i);
+	}
+	stride = (count + BLOCK - 1) / BLOCK * BLOCK;
+
+	if (method == AUTO) {
+		method = graph.edge_count() * JOHNSON_DENSITY < count * count ? JOHNSON : FLOYD_WARSHALL;
+	}
+	if (method == JOHNSON) {
+		johnson(graph, keepPaths, threads);
+		return;
+	}
+
+	// Padding rows and columns stay at INFINITY, so they never shorten anything.
+	distance.assign(stride * stride, INFINITY);
+	previous.clear();
+	if (keepPaths) { previous.assign(stride * stride, NULL_HANDLE); }
+	for (uint32_t u = 0; u < count; u++) {
+		distance[u * stride + u] = 0;
+		if (keepPaths) { previous[u * stride + u] = u; }
+		for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; e++) {
+			uint32_t x = graph.targets[e];
+			if (graph.weights[e] < distance[u * stride + x]) {
+				distance[u * stride + x] = graph.weights[e];
+				if (keepPaths) { previous[u * stride + x] = u; }
+			}
+		}
+	}
+	floyd_warshall(keepPaths, threads);
+}
+
+
+void AllPairsShortestPaths::floyd_warshall(bool keepPaths, size_t threads) {
+
+	size_t tiles = stride / BLOCK;
+	ThreadPool pool(threads);
+	auto relax = [this, keepPaths](size_t ib, size_t jb, size_t kb) {
+		if (keepPaths) {
+			relax_tile<true>(ib, jb, kb);
+		}
+		else {
+			relax_tile<false>(ib, jb, kb);
+		}
+	};
+
+	for (size_t kb = 0; kb < tiles; kb++) {
+		relax(kb, kb, kb);
+
+		// Tiles in row kb and column kb only depend on the diagonal tile.
+		pool.parallel_for(0, 2 * tiles, [&](size_t begin, size_t end, size_t) {
+			for (size_t t = begin; t < end; t++) {
+				size_t other = t < tiles ? t : t - tiles;
+				if (other == kb) { continue; }
+				if (t < tiles) {
+					relax(kb, other, kb);
+				}
+				else {
+					relax(other, kb, kb);
+				}
+			}
+		}, 1);
+
+		// Every other tile only reads the finished tiles of row kb and column kb.
+		pool.parallel_for(0, tiles * tiles, [&](size_t begin, size_t end, size_t) {
+			for (size_t t = begin; t < end; t++) {
+				size_t ib = t / tiles, jb = t % tiles;
+				if (ib == kb || jb == kb) { continue; }
+				relax(ib, jb, kb);
+			}
+		}, 1);
+	}
+}
+
+
+void AllPairsShortestPaths::johnson(const CSRGraph& graph, bool keepPaths, size_t threads) {
+
+	distance.assign(count * stride, INFINITY);
+	previous.clear();
+	if (keepPaths) { previous.assign(count * stride, NULL_HANDLE); }
+
+	ThreadPool pool(threads);
+	pool.parallel_for(0, count, [&](size_t begin, size_t end, size_t) {
+		std::vector<double> rowDistance;
+		std::vector<uint32_t> rowPrevious;
+		for (size_t s = begin; s < end; s++) {
+			graph.dijsktras_algorithm(static_cast<uint32_t>(s), rowDistance, rowPrevious);
+			std::copy(rowDistance.begin(), rowDistance.end(), distance.begin() + s * stride);
+			if (keepPaths) {
+				std::copy(rowPrevious.begin(), rowPrevious.end(), previous.begin() + s * stride);
+			}
+		}
+	}, 1);
+}
+
+
+template<bool KeepPaths>
+void AllPairsShortestPaths::relax_tile(size_t ib, size_t jb, size_t kb) {
+
+	for (size_t k = kb * BLOCK; k < (kb + 1) * BLOCK; k++) {
+		const double* via = &distance[k * stride + jb * BLOCK];
+		const uint32_t* viaPrevious = KeepPaths ? &previous[k * stride + jb * BLOCK] : nullptr;
+		for (size_t i = ib * BLOCK; i < (ib + 1) * BLOCK; i++) {
+			// Going from row k through k itself changes nothing, and would alias the two rows.
+			if (i == k) { continue; }
+			double viaWeight = distance[i * stride + k];
+			if (viaWeight == INFINITY) { continue; }
+			relax_row<KeepPaths>(&distance[i * stride + jb * BLOCK],
+				KeepPaths ? &previous[i * stride + jb * BLOCK] : nullptr, via, viaPrevious, viaWeight);
+		}
+	}
+}
+
+
+template<bool KeepPaths>
+void AllPairsShortestPaths::relax_row(double* __restrict target, uint32_t* __restrict targetPrevious,
+	const double* __restrict via, const uint32_t* __restrict viaPrevious, double viaWeight) {
+
+	// Written as selects rather than branches so the loop vectorizes. Carrying predecessors along
+	// mixes element widths, which most compilers leave scalar, so the matrix without paths is the
+	// fast one.
+	for (size_t j = 0; j < BLOCK; j++) {
+		double routedWeight = viaWeight + via[j];
+		if constexpr (KeepPaths) {
+			bool shorter = routedWeight < target[j];
+			target[j] = shorter ? routedWeight : target[j];
+			targetPrevious[j] = shorter ? viaPrevious[j] : targetPrevious[j];
+		}
+		else {
+			target[j] = routedWeight < target[j] ? routedWeight : target[j];
+		}
+	}
+}
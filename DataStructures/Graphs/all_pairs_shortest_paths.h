@@ -0,0 +1,93 @@
+#pragma once
+#include "graph.h"
+#include "csr_graph.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+/* Dense all pairs shortest path matrix over a graph snapshot. The graph is exported to an
+N x N matrix of doubles (plus one of predecessors when paths are kept), so this is meant for
+dense subgraphs of up to a few thousand nodes.
+
+Floyd-Warshall runs over BLOCK x BLOCK tiles so the three tiles each step touches stay in cache.
+Each round finishes the diagonal tile, then the tiles sharing its row or column, then every
+other tile, with the tiles of each phase relaxed in parallel. The innermost loop is a plain
+min over two rows that the compiler turns into SIMD code when paths are not kept.
+
+Johnson's algorithm runs one Dijkstra per source in parallel instead, which wins on sparse
+inputs. Graph weights are never negative, so its Bellman-Ford reweighting pass is skipped. */
+class AllPairsShortestPaths {
+
+public:
+
+	// Side of a Floyd-Warshall tile; three 64 x 64 tiles of doubles take 96KB.
+	static const size_t BLOCK = 64;
+
+	enum Method {
+		// Johnson when the graph has fewer than N * N / JOHNSON_DENSITY edges, else Floyd-Warshall.
+		AUTO,
+		FLOYD_WARSHALL,
+		JOHNSON
+	};
+
+	static const size_t JOHNSON_DENSITY = 16;
+
+	std::string graphId;
+	size_t count = 0;
+	// Row length of the matrices: count rounded up to a whole number of tiles.
+	size_t stride = 0;
+	std::vector<std::string> ids;
+	std::map<std::string, uint32_t> handles;
+
+	// distance[i * stride + j] is the shortest path weight from i to j, or INFINITY.
+	std::vector<double> distance;
+	// previous[i * stride + j] is the node before j on that path, or NULL_HANDLE. Left empty
+	// unless paths were asked for.
+	std::vector<uint32_t> previous;
+
+public:
+
+	/* Zero threads means one per hardware thread. */
+	AllPairsShortestPaths(const CSRGraph& graph, Method method = AUTO, bool keepPaths = false,
+		size_t threads = 0);
+
+
+	AllPairsShortestPaths(const Graph& graph, Method method = AUTO, bool keepPaths = false,
+		size_t threads = 0);
+
+
+	/* Returns the shortest path weight from start to end, or INFINITY. If path is given it is
+	filled from start to end; that needs the matrix to have been built with keepPaths. */
+	double query(uint32_t start, uint32_t end, std::vector<uint32_t>* path = nullptr) const;
+
+
+	double query(const std::string& startId, const std::string& endId, std::vector<std::string>* path = nullptr) const;
+
+
+	uint32_t get_handle(const std::string& id) const;
+
+
+	std::string to_string() const;
+
+protected:
+
+	void build(const CSRGraph& graph, Method method, bool keepPaths, size_t threads);
+
+
+	void floyd_warshall(bool keepPaths, size_t threads);
+
+
+	void johnson(const CSRGraph& graph, bool keepPaths, size_t threads);
+
+
+	// Relaxes tile (ib, jb) through every node of tile kb.
+	template<bool KeepPaths>
+	void relax_tile(size_t ib, size_t jb, size_t kb);
+
+
+	// target[j] = min(target[j], viaWeight + via[j]) over one tile row, carrying predecessors along.
+	template<bool KeepPaths>
+	static void relax_row(double* __restrict target, uint32_t* __restrict targetPrevious,
+		const double* __restrict via, const uint32_t* __restrict viaPrevious, double viaWeight);
+};
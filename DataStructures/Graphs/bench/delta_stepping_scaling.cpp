@@ -0,0 +1,80 @@
+/* Scaling benchmark for Graph::delta_stepping against the sequential Dijkstra engine.
+
+Builds a random weighted graph, times dijsktras_algorithm from a fixed start, then times
+delta_stepping from the same start with 1, 2, ... maxThreads threads. Every run's distances are
+checked against Dijkstra's. Each time is the best of reps runs.
+
+Build from DataStructures/Graphs:
+	g++ -O2 -std=c++20 -I. bench/delta_stepping_scaling.cpp graph.cpp graph_node.cpp csr_graph.cpp \
+		tree.cpp tree_node.cpp -pthread -o delta_stepping_scaling
+
+Usage:
+	delta_stepping_scaling [nodes = 100000] [out degree = 5] [max threads = hardware] [reps = 3] [delta = 0]
+*/
+#include "../graph.h"
+#include <chrono>
+#include <random>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+
+template<typename F>
+double best_seconds(size_t reps, F run) {
+	double best = INFINITY;
+	for (size_t i = 0; i < reps; i++) {
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		run();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		if (seconds < best) { best = seconds; }
+	}
+	return best;
+}
+
+
+int main(int argc, char** argv) {
+
+	size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+	size_t degree = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+	size_t maxThreads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::thread::hardware_concurrency();
+	size_t reps = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 3;
+	double delta = argc > 5 ? std::strtod(argv[5], nullptr) : 0;
+	if (!nodes) { nodes = 1; }
+	if (!maxThreads) { maxThreads = 1; }
+	if (!reps) { reps = 1; }
+
+	Graph graph("delta stepping benchmark", true);
+	std::mt19937 random(34);
+	std::uniform_real_distribution<double> weight(1, 100);
+	for (size_t v = 0; v < nodes; v++) {
+		graph.insert(std::to_string(v));
+	}
+	for (uint32_t v = 0; v < nodes; v++) {
+		for (size_t e = 0; e < degree; e++) {
+			uint32_t child = static_cast<uint32_t>(random() % nodes);
+			if (child != v) { graph.make_edge(v, child, weight(random)); }
+		}
+	}
+
+	std::vector<double> expected, distance;
+	std::vector<uint32_t> previous;
+	double dijkstraSeconds = best_seconds(reps, [&]() { graph.dijsktras_algorithm(0, expected, previous); });
+	std::cout << "nodes " << nodes << ", out degree " << degree << ", best of " << reps << "\n"
+		<< "dijkstra " << std::fixed << std::setprecision(4) << dijkstraSeconds << "s\n"
+		<< "threads   seconds   vs dijkstra   vs 1 thread   distances\n";
+
+	double oneThreadSeconds = 0;
+	for (size_t threads = 1; threads <= maxThreads; threads++) {
+		double seconds = best_seconds(reps, [&]() { graph.delta_stepping(0, distance, delta, threads); });
+		if (threads == 1) { oneThreadSeconds = seconds; }
+		bool matches = distance == expected;
+		std::cout << std::setw(7) << threads << std::setw(10) << seconds
+			<< std::setw(13) << dijkstraSeconds / seconds << "x"
+			<< std::setw(13) << oneThreadSeconds / seconds << "x"
+			<< "   " << (matches ? "match" : "MISMATCH") << "\n";
+	}
+	return 0;
+}
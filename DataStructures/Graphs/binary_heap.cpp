@@ -229,6 +229,7 @@ void BinaryHeap::create_node(const std::string& id, double data, size_t index) {
 	BinaryHeapNode* newGraphNode = new BinaryHeapNode(*nodeId, data, index);
 	this->ids->append(*nodeId);
 	this->nodes->put(id, *newGraphNode);
+	this->register_node(newGraphNode);
 }
 
 
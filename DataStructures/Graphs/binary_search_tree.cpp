@@ -158,6 +158,7 @@ void BinarySearchTree::create_node(const std::string& id, double data, const boo
 	BinarySearchTreeNode* newGraphNode = new BinarySearchTreeNode(*nodeId, data, weighted);
 	this->ids->append(*nodeId);
 	this->nodes->put(id, *newGraphNode);
+	this->register_node(newGraphNode);
 }
 
 
@@ -62,6 +62,7 @@ void BinaryTree::create_node(const std::string& id, const bool weighted) {
 	BinaryTreeNode* newGraphNode = new BinaryTreeNode(*nodeId, weighted);
 	this->ids->append(*nodeId);
 	this->nodes->put(id, *newGraphNode);
+	this->register_node(newGraphNode);
 }
 
 
@@ -0,0 +1,514 @@
+#include "contraction_hierarchy.h"
+#include <cmath>
+#include <queue>
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+
+ContractionHierarchy::ContractionHierarchy() {}
+
+
+ContractionHierarchy::ContractionHierarchy(const CSRGraph& graph) {
+	build(graph);
+}
+
+
+void ContractionHierarchy::build(const CSRGraph& graph) {
+
+	graphId = graph.graphId;
+	count = graph.count;
+	ids = graph.ids;
+	handles.clear();
+	for (uint32_t i = 0; i < count; i++) {
+		handles.emplace(ids[i], i);
+	}
+
+	// Working copy of the graph that shortcuts are added to as nodes are contracted.
+	std::vector<std::vector<CHEdge>> out(count), in(count);
+	for (uint32_t u = 0; u < count; u++) {
+		for (uint32_t e = graph.offsets[u]; e < graph.offsets[u + 1]; e++) {
+			uint32_t x = graph.targets[e];
+			if (x == u) { continue; }
+			add_or_lower(out[u], x, graph.weights[e], NULL_HANDLE);
+			add_or_lower(in[x], u, graph.weights[e], NULL_HANDLE);
+		}
+	}
+	std::vector<std::tuple<uint32_t, uint32_t, double, uint32_t>> edges;
+	for (uint32_t u = 0; u < count; u++) {
+		for (CHEdge& edge : out[u]) {
+			edges.emplace_back(u, edge.node, edge.weight, NULL_HANDLE);
+		}
+	}
+
+	witnessDistance.assign(count, INFINITY);
+	witnessReached.clear();
+	std::vector<bool> contracted(count, false);
+	std::vector<int> contractedNeighbors(count, 0);
+	typedef std::pair<int, uint32_t> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> order;
+	for (uint32_t v = 0; v < count; v++) {
+		order.push({ priority(v, out, in, contracted, contractedNeighbors), v });
+	}
+
+	rank.assign(count, 0);
+	shortcutCount = 0;
+	uint32_t nextRank = 0;
+	std::vector<std::pair<uint32_t, CHEdge>> shortcuts;
+	while (!order.empty()) {
+		uint32_t v = order.top().second;
+		order.pop();
+		if (contracted[v]) { continue; }
+
+		// Lazy update: priorities go stale as neighbors are contracted.
+		int current = priority(v, out, in, contracted, contractedNeighbors);
+		if (!order.empty() && current > order.top().first) {
+			order.push({ current, v });
+			continue;
+		}
+
+		find_shortcuts(v, out, in, contracted, shortcuts);
+		for (std::pair<uint32_t, CHEdge>& shortcut : shortcuts) {
+			uint32_t u = shortcut.first;
+			CHEdge& edge = shortcut.second;
+			add_or_lower(out[u], edge.node, edge.weight, v);
+			add_or_lower(in[edge.node], u, edge.weight, v);
+			edges.emplace_back(u, edge.node, edge.weight, v);
+		}
+		shortcutCount += shortcuts.size();
+
+		contracted[v] = true;
+		rank[v] = nextRank++;
+		for (CHEdge& edge : out[v]) { contractedNeighbors[edge.node]++; }
+		for (CHEdge& edge : in[v]) { contractedNeighbors[edge.node]++; }
+	}
+
+	// Keep only the lightest edge for every (u, x), then split by rank into the two search graphs.
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end(),
+		[](const std::tuple<uint32_t, uint32_t, double, uint32_t>& a,
+			const std::tuple<uint32_t, uint32_t, double, uint32_t>& b) {
+			return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b);
+		}), edges.end());
+
+	upOffsets.assign(count + 1, 0);
+	downOffsets.assign(count + 1, 0);
+	for (auto& edge : edges) {
+		uint32_t u = std::get<0>(edge), x = std::get<1>(edge);
+		if (rank[u] < rank[x]) { upOffsets[u + 1]++; }
+		else { downOffsets[x + 1]++; }
+	}
+	for (size_t i = 0; i < count; i++) {
+		upOffsets[i + 1] += upOffsets[i];
+		downOffsets[i + 1] += downOffsets[i];
+	}
+	upTargets.resize(upOffsets[count]);
+	upWeights.resize(upOffsets[count]);
+	upMiddles.resize(upOffsets[count]);
+	downSources.resize(downOffsets[count]);
+	downWeights.resize(downOffsets[count]);
+	downMiddles.resize(downOffsets[count]);
+
+	std::vector<uint32_t> upFill(upOffsets.begin(), upOffsets.end() - 1);
+	std::vector<uint32_t> downFill(downOffsets.begin(), downOffsets.end() - 1);
+	for (auto& edge : edges) {
+		uint32_t u = std::get<0>(edge), x = std::get<1>(edge);
+		if (rank[u] < rank[x]) {
+			uint32_t e = upFill[u]++;
+			upTargets[e] = x;
+			upWeights[e] = std::get<2>(edge);
+			upMiddles[e] = std::get<3>(edge);
+		}
+		else {
+			uint32_t e = downFill[x]++;
+			downSources[e] = u;
+			downWeights[e] = std::get<2>(edge);
+			downMiddles[e] = std::get<3>(edge);
+		}
+	}
+
+	witnessDistance.clear();
+	witnessDistance.shrink_to_fit();
+	reset_scratch();
+}
+
+
+double ContractionHierarchy::query(uint32_t start, uint32_t end, std::vector<uint32_t>* path) const {
+
+	if (start >= count || end >= count) {
+		std::cerr << "ContractionHierarchy query failed: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	if (path) { path->clear(); }
+	if (start == end) {
+		if (path) { path->push_back(start); }
+		return 0;
+	}
+
+	reset_scratch();
+	forwardDistance[start] = 0;
+	backwardDistance[end] = 0;
+	touched.push_back(start);
+	touched.push_back(end);
+	forward.push(start, 0);
+	backward.push(end, 0);
+	double best = INFINITY;
+	uint32_t meeting = NULL_HANDLE;
+
+	while (true) {
+		bool forwardDone = forward.is_empty() || forward.top_key() >= best;
+		bool backwardDone = backward.is_empty() || backward.top_key() >= best;
+		if (forwardDone && backwardDone) { break; }
+		bool isForward = !forwardDone && (backwardDone || forward.top_key() <= backward.top_key());
+
+		IndexedHeap<4>& heap = isForward ? forward : backward;
+		std::vector<double>& distance = isForward ? forwardDistance : backwardDistance;
+		std::vector<double>& otherDistance = isForward ? backwardDistance : forwardDistance;
+		std::vector<uint32_t>& previous = isForward ? forwardPrevious : backwardPrevious;
+		const std::vector<uint32_t>& offsets = isForward ? upOffsets : downOffsets;
+		const std::vector<uint32_t>& neighbors = isForward ? upTargets : downSources;
+		const std::vector<double>& weights = isForward ? upWeights : downWeights;
+
+		uint32_t curr = heap.pop();
+		if (distance[curr] + otherDistance[curr] < best) {
+			best = distance[curr] + otherDistance[curr];
+			meeting = curr;
+		}
+		for (uint32_t e = offsets[curr]; e < offsets[curr + 1]; e++) {
+			uint32_t next = neighbors[e];
+			double routedWeight = distance[curr] + weights[e];
+			if (routedWeight < distance[next]) {
+				if (std::isinf(forwardDistance[next]) && std::isinf(backwardDistance[next])) {
+					touched.push_back(next);
+				}
+				distance[next] = routedWeight;
+				previous[next] = curr;
+				heap.push_or_decrease(next, routedWeight);
+			}
+		}
+	}
+
+	if (path && meeting != NULL_HANDLE) {
+		std::vector<uint32_t> upward;
+		for (uint32_t curr = meeting; curr != start; curr = forwardPrevious[curr]) {
+			upward.push_back(curr);
+		}
+		path->push_back(start);
+		uint32_t last = start;
+		for (size_t i = upward.size(); i-- > 0;) {
+			unpack_edge(last, upward[i], *path);
+			last = upward[i];
+		}
+		for (uint32_t curr = meeting; curr != end;) {
+			uint32_t next = backwardPrevious[curr];
+			unpack_edge(curr, next, *path);
+			curr = next;
+		}
+	}
+	return best;
+}
+
+
+double ContractionHierarchy::query(const std::string& startId, const std::string& endId,
+	std::vector<std::string>* path) const {
+
+	std::vector<uint32_t> handlePath;
+	double weight = query(get_handle(startId), get_handle(endId), path ? &handlePath : nullptr);
+	if (path) {
+		for (uint32_t handle : handlePath) {
+			path->push_back(ids[handle]);
+		}
+	}
+	return weight;
+}
+
+
+uint32_t ContractionHierarchy::get_handle(const std::string& id) const {
+	std::map<std::string, uint32_t>::const_iterator found = handles.find(id);
+	if (found == handles.end()) {
+		std::cerr << "Node <" << id << "> is not in ContractionHierarchy <" << graphId << ">." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	return found->second;
+}
+
+
+void ContractionHierarchy::save(const std::string& filename) const {
+
+	std::ofstream file(filename, std::ios::binary);
+	if (!file) {
+		std::cerr << "Could not open <" << filename << "> for writing." << std::endl;
+		throw std::runtime_error("Could not open file for writing.");
+	}
+	auto write_size = [&](uint64_t size) {
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	};
+	auto write_string = [&](const std::string& value) {
+		write_size(value.size());
+		file.write(value.data(), value.size());
+	};
+	auto write_vector = [&](const auto& values) {
+		write_size(values.size());
+		file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(values[0]));
+	};
+
+	file.write("GCH1", 4);
+	write_string(graphId);
+	write_size(count);
+	write_size(shortcutCount);
+	for (const std::string& id : ids) {
+		write_string(id);
+	}
+	write_vector(rank);
+	write_vector(upOffsets);
+	write_vector(upTargets);
+	write_vector(upWeights);
+	write_vector(upMiddles);
+	write_vector(downOffsets);
+	write_vector(downSources);
+	write_vector(downWeights);
+	write_vector(downMiddles);
+
+	if (!file) {
+		std::cerr << "Failed writing ContractionHierarchy to <" << filename << ">." << std::endl;
+		throw std::runtime_error("Failed writing file.");
+	}
+}
+
+
+void ContractionHierarchy::load(const std::string& filename) {
+
+	std::ifstream file(filename, std::ios::binary);
+	char magic[4] = {};
+	file.read(magic, 4);
+	if (!file || std::string(magic, 4) != "GCH1") {
+		std::cerr << "<" << filename << "> is not a saved ContractionHierarchy." << std::endl;
+		throw std::invalid_argument("Not a saved ContractionHierarchy.");
+	}
+	file.seekg(0, std::ios::end);
+	uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+	file.seekg(4);
+
+	auto corrupt = [&filename]() {
+		std::cerr << "<" << filename << "> holds a truncated or corrupted ContractionHierarchy." << std::endl;
+		throw std::invalid_argument("Truncated ContractionHierarchy.");
+	};
+	auto read_value = [&]() {
+		uint64_t value = 0;
+		file.read(reinterpret_cast<char*>(&value), sizeof(value));
+		if (!file) { corrupt(); }
+		return value;
+	};
+	// A length is only trusted if the file still holds that many elements, so a corrupted one
+	// fails here instead of asking resize for an enormous buffer.
+	auto read_size = [&](size_t elementSize) {
+		uint64_t size = read_value();
+		if (size > (fileSize - static_cast<uint64_t>(file.tellg())) / elementSize) { corrupt(); }
+		return static_cast<size_t>(size);
+	};
+	auto read_string = [&](std::string& value) {
+		value.resize(read_size(1));
+		file.read(&value[0], value.size());
+	};
+	auto read_vector = [&](auto& values) {
+		values.resize(read_size(sizeof(values[0])));
+		file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(values[0]));
+	};
+
+	read_string(graphId);
+	// Every id is stored behind its 8 byte length.
+	count = read_size(sizeof(uint64_t));
+	shortcutCount = static_cast<size_t>(read_value());
+	ids.resize(count);
+	handles.clear();
+	for (uint32_t i = 0; i < count; i++) {
+		read_string(ids[i]);
+		handles.emplace(ids[i], i);
+	}
+	read_vector(rank);
+	read_vector(upOffsets);
+	read_vector(upTargets);
+	read_vector(upWeights);
+	read_vector(upMiddles);
+	read_vector(downOffsets);
+	read_vector(downSources);
+	read_vector(downWeights);
+	read_vector(downMiddles);
+	if (!file || rank.size() != count) { corrupt(); }
+	for (uint32_t r : rank) {
+		if (r >= count) { corrupt(); }
+	}
+
+	// Offsets must start at zero, never decrease and end at the edge count. Every edge's far end
+	// must be a node, and a shortcut's middle must rank below both its ends, or unpack_edge could
+	// recurse forever.
+	auto check_edges = [&](const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& ends,
+		const std::vector<double>& weights, const std::vector<uint32_t>& middles) {
+
+		if (offsets.size() != count + 1 || offsets[0] != 0 || offsets[count] != ends.size()
+			|| weights.size() != ends.size() || middles.size() != ends.size()) {
+			corrupt();
+		}
+		for (uint32_t v = 0; v < count; v++) {
+			if (offsets[v] > offsets[v + 1]) { corrupt(); }
+		}
+		for (uint32_t v = 0; v < count; v++) {
+			for (uint32_t e = offsets[v]; e < offsets[v + 1]; e++) {
+				uint32_t end = ends[e], middle = middles[e];
+				if (end >= count) { corrupt(); }
+				if (middle == NULL_HANDLE) { continue; }
+				if (middle >= count || rank[middle] >= rank[v] || rank[middle] >= rank[end]) { corrupt(); }
+			}
+		}
+	};
+	check_edges(upOffsets, upTargets, upWeights, upMiddles);
+	check_edges(downOffsets, downSources, downWeights, downMiddles);
+	reset_scratch();
+}
+
+
+std::string ContractionHierarchy::to_string() const {
+	std::stringstream ss;
+	ss << "__ContractionHierarchy__{id: " << graphId << ", count: " << count
+		<< ", upward edges: " << upTargets.size() << ", downward edges: " << downSources.size()
+		<< ", shortcuts: " << shortcutCount << "}";
+	return ss.str();
+}
+
+
+void ContractionHierarchy::find_shortcuts(uint32_t v, std::vector<std::vector<CHEdge>>& out,
+	std::vector<std::vector<CHEdge>>& in, std::vector<bool>& contracted,
+	std::vector<std::pair<uint32_t, CHEdge>>& shortcuts) {
+
+	shortcuts.clear();
+	double maxOut = 0;
+	for (CHEdge& edge : out[v]) {
+		if (!contracted[edge.node] && edge.weight > maxOut) { maxOut = edge.weight; }
+	}
+
+	for (CHEdge& incoming : in[v]) {
+		uint32_t u = incoming.node;
+		if (contracted[u]) { continue; }
+
+		witness_search(u, v, incoming.weight + maxOut, out, contracted);
+		for (CHEdge& outgoing : out[v]) {
+			uint32_t x = outgoing.node;
+			if (contracted[x] || x == u) { continue; }
+			double viaWeight = incoming.weight + outgoing.weight;
+			if (witnessDistance[x] > viaWeight) {
+				shortcuts.push_back({ u, CHEdge{ x, viaWeight, v } });
+			}
+		}
+		for (uint32_t reached : witnessReached) {
+			witnessDistance[reached] = INFINITY;
+		}
+		witnessReached.clear();
+	}
+}
+
+
+int ContractionHierarchy::priority(uint32_t v, std::vector<std::vector<CHEdge>>& out,
+	std::vector<std::vector<CHEdge>>& in, std::vector<bool>& contracted,
+	std::vector<int>& contractedNeighbors) {
+
+	std::vector<std::pair<uint32_t, CHEdge>> shortcuts;
+	find_shortcuts(v, out, in, contracted, shortcuts);
+	int removed = 0;
+	for (CHEdge& edge : out[v]) { if (!contracted[edge.node]) { removed++; } }
+	for (CHEdge& edge : in[v]) { if (!contracted[edge.node]) { removed++; } }
+	return static_cast<int>(shortcuts.size()) - removed + contractedNeighbors[v];
+}
+
+
+void ContractionHierarchy::witness_search(uint32_t source, uint32_t skip, double bound,
+	std::vector<std::vector<CHEdge>>& out, std::vector<bool>& contracted) {
+
+	typedef std::pair<double, uint32_t> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> remaining;
+	witnessDistance[source] = 0;
+	witnessReached.push_back(source);
+	remaining.push({ 0, source });
+	size_t settled = 0;
+
+	while (!remaining.empty()) {
+		entry curr = remaining.top();
+		remaining.pop();
+		if (curr.first > witnessDistance[curr.second]) { continue; }
+		if (curr.first > bound || ++settled > WITNESS_SETTLE_LIMIT) { break; }
+
+		for (CHEdge& edge : out[curr.second]) {
+			if (edge.node == skip || contracted[edge.node]) { continue; }
+			double routedWeight = curr.first + edge.weight;
+			if (routedWeight < witnessDistance[edge.node]) {
+				if (std::isinf(witnessDistance[edge.node])) {
+					witnessReached.push_back(edge.node);
+				}
+				witnessDistance[edge.node] = routedWeight;
+				remaining.push({ routedWeight, edge.node });
+			}
+		}
+	}
+}
+
+
+void ContractionHierarchy::add_or_lower(std::vector<CHEdge>& edges, uint32_t node, double weight, uint32_t middle) {
+	for (CHEdge& edge : edges) {
+		if (edge.node == node) {
+			if (weight < edge.weight) {
+				edge.weight = weight;
+				edge.middle = middle;
+			}
+			return;
+		}
+	}
+	edges.push_back(CHEdge{ node, weight, middle });
+}
+
+
+void ContractionHierarchy::reset_scratch() const {
+	if (forwardDistance.size() != count) {
+		forwardDistance.assign(count, INFINITY);
+		backwardDistance.assign(count, INFINITY);
+		forwardPrevious.assign(count, NULL_HANDLE);
+		backwardPrevious.assign(count, NULL_HANDLE);
+		forward = IndexedHeap<4>(count);
+		backward = IndexedHeap<4>(count);
+		touched.clear();
+		return;
+	}
+	for (uint32_t node : touched) {
+		forwardDistance[node] = INFINITY;
+		backwardDistance[node] = INFINITY;
+		forwardPrevious[node] = NULL_HANDLE;
+		backwardPrevious[node] = NULL_HANDLE;
+	}
+	touched.clear();
+	forward.clear();
+	backward.clear();
+}
+
+
+void ContractionHierarchy::unpack_edge(uint32_t u, uint32_t x, std::vector<uint32_t>& path) const {
+
+	uint32_t middle = NULL_HANDLE;
+	if (rank[u] < rank[x]) {
+		for (uint32_t e = upOffsets[u]; e < upOffsets[u + 1]; e++) {
+			if (upTargets[e] == x) { middle = upMiddles[e]; break; }
+		}
+	}
+	else {
+		for (uint32_t e = downOffsets[x]; e < downOffsets[x + 1]; e++) {
+			if (downSources[e] == u) { middle = downMiddles[e]; break; }
+		}
+	}
+	if (middle == NULL_HANDLE) {
+		path.push_back(x);
+		return;
+	}
+	unpack_edge(u, middle, path);
+	unpack_edge(middle, x, path);
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "csr_graph.h"
+#include "../indexed_heap.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+/* Contraction hierarchy over a CSRGraph snapshot, for answering many point-to-point shortest path
+queries on the same graph. Building contracts the nodes one at a time, least important first by
+edge difference, adding a shortcut u -> x through v whenever a bounded witness search finds no
+path from u to x at most as short without v. A query then runs Dijkstra upward (toward higher
+ranked nodes) from both ends and only touches a small part of the graph.
+
+Handles match the snapshot the hierarchy was built from. Queries reuse internal scratch space,
+so a hierarchy must not be queried from several threads at once. */
+class ContractionHierarchy {
+
+public:
+
+	// Maximum number of nodes a single witness search may settle before giving up.
+	static const size_t WITNESS_SETTLE_LIMIT = 500;
+
+	std::string graphId;
+	size_t count = 0;
+	std::vector<std::string> ids;
+	std::map<std::string, uint32_t> handles;
+	std::vector<uint32_t> rank;
+
+	// Edges u -> x with rank[u] < rank[x], stored at u.
+	std::vector<uint32_t> upOffsets;
+	std::vector<uint32_t> upTargets;
+	std::vector<double> upWeights;
+	std::vector<uint32_t> upMiddles;
+
+	// Edges u -> x with rank[u] > rank[x], stored at x and pointing back at u.
+	std::vector<uint32_t> downOffsets;
+	std::vector<uint32_t> downSources;
+	std::vector<double> downWeights;
+	std::vector<uint32_t> downMiddles;
+
+	size_t shortcutCount = 0;
+
+protected:
+
+	struct CHEdge {
+		uint32_t node;
+		double weight;
+		uint32_t middle;
+	};
+
+	// Build-time scratch for witness searches.
+	std::vector<double> witnessDistance;
+	std::vector<uint32_t> witnessReached;
+
+	mutable std::vector<double> forwardDistance, backwardDistance;
+	mutable std::vector<uint32_t> forwardPrevious, backwardPrevious;
+	mutable std::vector<uint32_t> touched;
+	mutable IndexedHeap<4> forward, backward;
+
+public:
+
+	ContractionHierarchy();
+
+
+	ContractionHierarchy(const CSRGraph& graph);
+
+
+	void build(const CSRGraph& graph);
+
+
+	/* Returns the shortest path weight from start to end, or INFINITY. If path is given it is
+	filled with the original (unpacked) nodes from start to end. */
+	double query(uint32_t start, uint32_t end, std::vector<uint32_t>* path = nullptr) const;
+
+
+	double query(const std::string& startId, const std::string& endId, std::vector<std::string>* path = nullptr) const;
+
+
+	uint32_t get_handle(const std::string& id) const;
+
+
+	/* Writes the hierarchy in a compact binary form so preprocessing can be skipped on restart. */
+	void save(const std::string& filename) const;
+
+
+	void load(const std::string& filename);
+
+
+	std::string to_string() const;
+
+protected:
+
+	// Finds the shortcuts contracting v needs right now, returned as (source, edge) pairs.
+	void find_shortcuts(uint32_t v, std::vector<std::vector<CHEdge>>& out, std::vector<std::vector<CHEdge>>& in,
+		std::vector<bool>& contracted, std::vector<std::pair<uint32_t, CHEdge>>& shortcuts);
+
+
+	int priority(uint32_t v, std::vector<std::vector<CHEdge>>& out, std::vector<std::vector<CHEdge>>& in,
+		std::vector<bool>& contracted, std::vector<int>& contractedNeighbors);
+
+
+	// Dijkstra from source avoiding skip and contracted nodes, stopping past bound. Leaves its
+	// distances in witnessDistance until the caller resets the witnessReached entries.
+	void witness_search(uint32_t source, uint32_t skip, double bound, std::vector<std::vector<CHEdge>>& out,
+		std::vector<bool>& contracted);
+
+
+	static void add_or_lower(std::vector<CHEdge>& edges, uint32_t node, double weight, uint32_t middle);
+
+
+	void reset_scratch() const;
+
+
+	// Appends the original nodes of edge u -> x, excluding u, to path.
+	void unpack_edge(uint32_t u, uint32_t x, std::vector<uint32_t>& path) const;
+};
@@ -0,0 +1,215 @@
+#include "csr_graph.h"
+#include <cmath>
+#include <queue>
+#include <stdexcept>
+#include <functional>
+#include <iostream>
+
+
+CSRGraph::CSRGraph(const std::string& graphId, bool weighted, std::vector<std::string>&& ids,
+	std::vector<uint32_t>&& offsets, std::vector<uint32_t>&& targets, std::vector<double>&& weights,
+	std::vector<uint32_t>&& reverseOffsets, std::vector<uint32_t>&& sources,
+	std::vector<double>&& reverseWeights)
+
+	: graphId(graphId), weighted(weighted), count(ids.size()), ids(std::move(ids)),
+	offsets(std::move(offsets)), targets(std::move(targets)), weights(std::move(weights)),
+	reverseOffsets(std::move(reverseOffsets)), sources(std::move(sources)),
+	reverseWeights(std::move(reverseWeights)) {}
+
+
+size_t CSRGraph::edge_count() const {
+	return targets.size();
+}
+
+
+std::string CSRGraph::to_string() const {
+
+	std::stringstream ss;
+	ss << "\n__CSRGraph__{id: " << graphId << "\n";
+	for (size_t i = 0; i < count; i++) {
+		ss << ids[i] << ": [";
+		for (uint32_t e = offsets[i]; e < offsets[i + 1]; e++) {
+			if (weighted) { ss << "("; }
+			ss << ids[targets[e]];
+			if (weighted) { ss << ", " << weights[e] << ")"; }
+			if (e + 1 != offsets[i + 1]) { ss << ", "; }
+		}
+		ss << "]\n";
+	}
+	ss << "count: " << count << ", edges: " << edge_count() << "}\n";
+	return ss.str();
+}
+
+
+void CSRGraph::breadth_first_search(uint32_t start, std::vector<uint32_t>& memo) const {
+
+	check_handle(start);
+	std::vector<bool> seen(count, false);
+	size_t head = memo.size();
+	seen[start] = true;
+	memo.push_back(start);
+
+	while (head < memo.size()) {
+		uint32_t curr = memo[head++];
+		for (uint32_t e = offsets[curr]; e < offsets[curr + 1]; e++) {
+			uint32_t child = targets[e];
+			if (!seen[child]) {
+				seen[child] = true;
+				memo.push_back(child);
+			}
+		}
+	}
+}
+
+
+void CSRGraph::depth_first_search(uint32_t start, std::vector<uint32_t>& memo) const {
+
+	check_handle(start);
+	std::vector<bool> seen(count, false);
+
+	// Each frame is (node, next edge to look at), so children are visited in list order.
+	std::vector<std::pair<uint32_t, uint32_t>> stack;
+	seen[start] = true;
+	memo.push_back(start);
+	stack.push_back({ start, offsets[start] });
+
+	while (!stack.empty()) {
+		std::pair<uint32_t, uint32_t>& frame = stack.back();
+		if (frame.second == offsets[frame.first + 1]) {
+			stack.pop_back();
+			continue;
+		}
+		uint32_t child = targets[frame.second++];
+		if (!seen[child]) {
+			seen[child] = true;
+			memo.push_back(child);
+			stack.push_back({ child, offsets[child] });
+		}
+	}
+}
+
+
+bool CSRGraph::topological_sort(std::vector<uint32_t>& memo) const {
+
+	std::vector<uint32_t> inDegree(count);
+	size_t head = memo.size();
+	for (uint32_t i = 0; i < count; i++) {
+		inDegree[i] = reverseOffsets[i + 1] - reverseOffsets[i];
+		if (inDegree[i] == 0) {
+			memo.push_back(i);
+		}
+	}
+	size_t first = head;
+	while (head < memo.size()) {
+		uint32_t curr = memo[head++];
+		for (uint32_t e = offsets[curr]; e < offsets[curr + 1]; e++) {
+			if (--inDegree[targets[e]] == 0) {
+				memo.push_back(targets[e]);
+			}
+		}
+	}
+	return memo.size() - first == count;
+}
+
+
+size_t CSRGraph::strongly_connected_components(std::vector<uint32_t>& component) const {
+
+	// First pass: forward post-order over the whole graph.
+	std::vector<uint32_t> finished;
+	finished.reserve(count);
+	std::vector<bool> seen(count, false);
+	std::vector<std::pair<uint32_t, uint32_t>> stack;
+
+	for (uint32_t root = 0; root < count; root++) {
+		if (seen[root]) { continue; }
+		seen[root] = true;
+		stack.push_back({ root, offsets[root] });
+		while (!stack.empty()) {
+			std::pair<uint32_t, uint32_t>& frame = stack.back();
+			if (frame.second == offsets[frame.first + 1]) {
+				finished.push_back(frame.first);
+				stack.pop_back();
+				continue;
+			}
+			uint32_t child = targets[frame.second++];
+			if (!seen[child]) {
+				seen[child] = true;
+				stack.push_back({ child, offsets[child] });
+			}
+		}
+	}
+
+	// Second pass: walk the reverse arrays in decreasing finish time.
+	component.assign(count, NULL_HANDLE);
+	uint32_t components = 0;
+	std::vector<uint32_t> toVisit;
+	for (size_t i = count; i-- > 0;) {
+		uint32_t root = finished[i];
+		if (component[root] != NULL_HANDLE) { continue; }
+		component[root] = components;
+		toVisit.push_back(root);
+		while (!toVisit.empty()) {
+			uint32_t curr = toVisit.back();
+			toVisit.pop_back();
+			for (uint32_t e = reverseOffsets[curr]; e < reverseOffsets[curr + 1]; e++) {
+				uint32_t parent = sources[e];
+				if (component[parent] == NULL_HANDLE) {
+					component[parent] = components;
+					toVisit.push_back(parent);
+				}
+			}
+		}
+		components++;
+	}
+	return components;
+}
+
+
+void CSRGraph::strongly_connected_components(std::vector<std::vector<uint32_t>>& memo) const {
+
+	std::vector<uint32_t> component;
+	size_t components = strongly_connected_components(component);
+	size_t first = memo.size();
+	memo.resize(first + components);
+	for (uint32_t i = 0; i < count; i++) {
+		memo[first + component[i]].push_back(i);
+	}
+}
+
+
+void CSRGraph::dijsktras_algorithm(uint32_t start, std::vector<double>& distance,
+	std::vector<uint32_t>& previous) const {
+
+	check_handle(start);
+	typedef std::pair<double, uint32_t> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> remaining;
+
+	distance.assign(count, INFINITY);
+	previous.assign(count, NULL_HANDLE);
+	distance[start] = 0;
+	previous[start] = start;
+	remaining.push({ 0, start });
+
+	while (!remaining.empty()) {
+		entry curr = remaining.top();
+		remaining.pop();
+		if (curr.first > distance[curr.second]) { continue; }
+
+		for (uint32_t e = offsets[curr.second]; e < offsets[curr.second + 1]; e++) {
+			double routedWeight = curr.first + weights[e];
+			if (routedWeight < distance[targets[e]]) {
+				distance[targets[e]] = routedWeight;
+				previous[targets[e]] = curr.second;
+				remaining.push({ routedWeight, targets[e] });
+			}
+		}
+	}
+}
+
+
+void CSRGraph::check_handle(uint32_t handle) const {
+	if (handle >= count) {
+		std::cerr << "Handle " << handle << " is not in CSRGraph <" << graphId << ">." << std::endl;
+		throw std::invalid_argument("Handle is not in the graph.");
+	}
+}
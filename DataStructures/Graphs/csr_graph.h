@@ -0,0 +1,70 @@
+#pragma once
+#include "graph_node.h"
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstdint>
+
+/* Immutable Compressed Sparse Row snapshot of a Graph, produced by Graph::to_csr(). Node i is the
+node with handle i in the graph at snapshot time. The children of i are targets[offsets[i]] up to
+targets[offsets[i + 1]], and its parents are sources[reverseOffsets[i]] up to
+sources[reverseOffsets[i + 1]]. Unweighted edges are stored with weight 1. */
+class CSRGraph {
+
+public:
+
+	const std::string graphId;
+	const bool weighted;
+	const size_t count;
+
+	const std::vector<std::string> ids;
+
+	const std::vector<uint32_t> offsets;
+	const std::vector<uint32_t> targets;
+	const std::vector<double> weights;
+
+	const std::vector<uint32_t> reverseOffsets;
+	const std::vector<uint32_t> sources;
+	const std::vector<double> reverseWeights;
+
+public:
+
+	CSRGraph(const std::string& graphId, bool weighted, std::vector<std::string>&& ids,
+		std::vector<uint32_t>&& offsets, std::vector<uint32_t>&& targets, std::vector<double>&& weights,
+		std::vector<uint32_t>&& reverseOffsets, std::vector<uint32_t>&& sources,
+		std::vector<double>&& reverseWeights);
+
+
+	size_t edge_count() const;
+
+
+	std::string to_string() const;
+
+
+	void breadth_first_search(uint32_t start, std::vector<uint32_t>& memo) const;
+
+
+	void depth_first_search(uint32_t start, std::vector<uint32_t>& memo) const;
+
+
+	/* Populates memo with every node after all of its parents. Returns false, leaving memo
+	holding only the nodes that could be ordered, if the graph contains a cycle. */
+	bool topological_sort(std::vector<uint32_t>& memo) const;
+
+
+	/* Labels every node with the index of its strongly connected component, and returns the
+	number of components. Uses the reverse arrays instead of transposing anything. */
+	size_t strongly_connected_components(std::vector<uint32_t>& component) const;
+
+
+	void strongly_connected_components(std::vector<std::vector<uint32_t>>& memo) const;
+
+
+	/* Unreachable nodes are left at INFINITY with previous NULL_HANDLE. */
+	void dijsktras_algorithm(uint32_t start, std::vector<double>& distance,
+		std::vector<uint32_t>& previous) const;
+
+protected:
+
+	void check_handle(uint32_t handle) const;
+};
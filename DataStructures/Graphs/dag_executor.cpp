@@ -0,0 +1,173 @@
+#include "dag_executor.h"
+#include "../thread_pool.h"
+#include <chrono>
+#include <algorithm>
+#include <exception>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+
+DagExecutor::DagExecutor(Graph& graph, size_t threads) : graph(&graph), threads(threads) {}
+
+
+void DagExecutor::run(const std::function<void(uint32_t)>& task) {
+
+	size_t N = graph->handle_count();
+	std::vector<uint32_t> order, levelOffsets, cycle;
+	if (!graph->topological_levels(order, levelOffsets, &cycle, 1)) {
+		std::cerr << "DAG not run: Graph has a cycle through <" << graph->get_id(cycle.front()) << ">." << std::endl;
+		throw std::invalid_argument("Graph has a cycle.");
+	}
+	timing.assign(N, Timing());
+	criticalPath.clear();
+	criticalPathTime = 0;
+	elapsed = 0;
+	if (!N) { return; }
+
+	ThreadPool pool(threads);
+	size_t workers = pool.size;
+	std::unique_ptr<WorkQueue[]> queues(new WorkQueue[workers]);
+	std::unique_ptr<std::atomic<uint32_t>[]> waiting(new std::atomic<uint32_t>[N]);
+	std::vector<double> pathTime(N, 0);
+	std::vector<uint32_t> pathPrevious(N, NULL_HANDLE);
+	std::atomic<size_t> queued(0), finished(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr failure;
+	std::mutex sleepLock;
+	std::condition_variable wake;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	auto seconds = [&begin]() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	};
+	// Taking the lock between changing what sleepers wait on and notifying them means no sleeper
+	// can check the condition before the change and start waiting after the notification.
+	auto wakeWorkers = [&sleepLock, &wake](bool all) {
+		{ std::lock_guard<std::mutex> guard(sleepLock); }
+		if (all) {
+			wake.notify_all();
+		}
+		else {
+			wake.notify_one();
+		}
+	};
+
+	for (uint32_t v = 0; v < N; v++) {
+		uint32_t parents = 0;
+		graph->for_each_neighbor(v, [&parents](uint32_t, double) { parents++; }, true);
+		waiting[v].store(parents, std::memory_order_relaxed);
+	}
+	// The roots are dealt out round robin so every worker starts busy.
+	for (uint32_t i = 0; i < levelOffsets[1]; i++) {
+		queues[i % workers].ready.push_back(order[i]);
+	}
+	queued.store(levelOffsets[1]);
+
+	auto push = [&](size_t worker, uint32_t v) {
+		{
+			std::lock_guard<std::mutex> guard(queues[worker].lock);
+			queues[worker].ready.push_back(v);
+		}
+		queued.fetch_add(1);
+		wakeWorkers(false);
+	};
+	auto take = [&](size_t worker, uint32_t& v) {
+		for (size_t i = 0; i < workers; i++) {
+			WorkQueue& queue = queues[(worker + i) % workers];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (queue.ready.empty()) { continue; }
+			if (i == 0) {
+				v = queue.ready.back();
+				queue.ready.pop_back();
+			}
+			else {
+				v = queue.ready.front();
+				queue.ready.pop_front();
+			}
+			queued.fetch_sub(1);
+			return true;
+		}
+		return false;
+	};
+
+	auto work = [&](size_t worker) {
+		uint32_t v;
+		while (!failed.load()) {
+			if (!take(worker, v)) {
+				std::unique_lock<std::mutex> guard(sleepLock);
+				wake.wait(guard, [&]() { return queued.load() || failed.load() || finished.load() == N; });
+				if (failed.load() || finished.load() == N) { return; }
+				continue;
+			}
+
+			// Every parent finished before v was queued, so their chains are complete.
+			double parentPathTime = 0;
+			uint32_t parentOnPath = NULL_HANDLE;
+			graph->for_each_neighbor(v, [&](uint32_t parent, double) {
+				if (parentOnPath == NULL_HANDLE || pathTime[parent] > parentPathTime) {
+					parentPathTime = pathTime[parent];
+					parentOnPath = parent;
+				}
+			}, true);
+
+			timing[v].worker = worker;
+			timing[v].start = seconds();
+			try {
+				task(v);
+			}
+			catch (...) {
+				{
+					std::lock_guard<std::mutex> guard(sleepLock);
+					if (!failure) { failure = std::current_exception(); }
+					failed.store(true);
+				}
+				wake.notify_all();
+				return;
+			}
+			timing[v].finish = seconds();
+			pathTime[v] = parentPathTime + (timing[v].finish - timing[v].start);
+			pathPrevious[v] = parentOnPath;
+
+			graph->for_each_neighbor(v, [&](uint32_t child, double) {
+				if (waiting[child].fetch_sub(1, std::memory_order_acq_rel) == 1) { push(worker, child); }
+			});
+			if (finished.fetch_add(1) + 1 == N) {
+				wakeWorkers(true);
+				return;
+			}
+		}
+	};
+
+	std::vector<std::future<void>> running;
+	for (size_t w = 0; w < workers; w++) {
+		running.push_back(pool.submit([&work, w]() { work(w); }));
+	}
+	for (std::future<void>& worker : running) {
+		worker.get();
+	}
+	elapsed = seconds();
+	if (failure) { std::rethrow_exception(failure); }
+	find_critical_path(pathTime, pathPrevious);
+}
+
+
+std::string DagExecutor::to_string() const {
+	std::stringstream ss;
+	ss << "__DagExecutor__{count: " << timing.size() << ", threads: " << threads << ", elapsed: " << elapsed
+		<< ", critical path: " << criticalPathTime << " over " << criticalPath.size() << " nodes}";
+	return ss.str();
+}
+
+
+void DagExecutor::find_critical_path(const std::vector<double>& pathTime, const std::vector<uint32_t>& pathPrevious) {
+
+	uint32_t last = 0;
+	for (uint32_t v = 1; v < pathTime.size(); v++) {
+		if (pathTime[v] > pathTime[last]) { last = v; }
+	}
+	criticalPathTime = pathTime[last];
+	for (uint32_t curr = last; curr != NULL_HANDLE; curr = pathPrevious[curr]) {
+		criticalPath.push_back(curr);
+	}
+	std::reverse(criticalPath.begin(), criticalPath.end());
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "graph.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+/* Runs one task per node of a DAG, each as soon as every parent's task has finished. Each node
+keeps an atomic count of unfinished parents, and whichever worker takes a count to zero queues
+that child on its own deque. Workers pop their own deque from the back, so a child usually runs
+right after its parent on the same thread while its inputs are still in cache. A worker whose
+deque runs dry steals from the front of the others' deques, where the oldest and usually largest
+pieces of work wait.
+
+Every run records when each task started and finished, and the critical path: the chain of
+tasks whose summed durations bound how fast the DAG can run however many workers there are.
+The graph must not change during a run. */
+class DagExecutor {
+
+public:
+
+	// Seconds since the start of the run, and the worker that ran the task.
+	struct Timing {
+		double start = 0;
+		double finish = 0;
+		size_t worker = 0;
+	};
+
+	Graph* graph;
+	size_t threads;
+	// Indexed by handle, for the most recent run.
+	std::vector<Timing> timing;
+	// Wall time of the most recent run, in seconds.
+	double elapsed = 0;
+	// Summed task durations along the critical path, and its handles from first to last.
+	double criticalPathTime = 0;
+	std::vector<uint32_t> criticalPath;
+
+protected:
+
+	struct WorkQueue {
+		std::mutex lock;
+		std::deque<uint32_t> ready;
+	};
+
+public:
+
+	/* Zero threads means one per hardware thread. */
+	DagExecutor(Graph& graph, size_t threads = 0);
+
+
+	/* Calls task(handle) once for every node, never before the tasks of all its parents have
+	returned. Throws if the graph has a cycle. If a task throws, no further tasks start, and the
+	first exception is rethrown once the tasks already running have returned. */
+	void run(const std::function<void(uint32_t)>& task);
+
+
+	std::string to_string() const;
+
+protected:
+
+	// Walks back from the node whose chain took longest.
+	void find_critical_path(const std::vector<double>& pathTime, const std::vector<uint32_t>& pathPrevious);
+};
@@ -0,0 +1,148 @@
+#include "dynamic_shortest_paths.h"
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+
+DynamicShortestPaths::DynamicShortestPaths(Graph& graph, uint32_t source) : graph(&graph), source(source) {
+	graph.dijsktras_algorithm(source, distance, previous);
+	remaining.resize(distance.size());
+	affected.assign(distance.size(), false);
+	graph.add_listener(this);
+}
+
+
+DynamicShortestPaths::DynamicShortestPaths(Graph& graph, const std::string& sourceId)
+	: DynamicShortestPaths(graph, graph.get_handle(sourceId)) {}
+
+
+DynamicShortestPaths::~DynamicShortestPaths() {
+	graph->remove_listener(this);
+}
+
+
+double DynamicShortestPaths::get_path(uint32_t handle, std::vector<uint32_t>& path) const {
+
+	if (handle >= distance.size()) {
+		std::cerr << "Path not found: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	path.clear();
+	if (distance[handle] == INFINITY) { return INFINITY; }
+	for (uint32_t curr = handle; curr != source; curr = previous[curr]) {
+		path.push_back(curr);
+	}
+	path.push_back(source);
+	std::reverse(path.begin(), path.end());
+	return distance[handle];
+}
+
+
+void DynamicShortestPaths::on_node_added(uint32_t) {
+	distance.push_back(INFINITY);
+	previous.push_back(NULL_HANDLE);
+	affected.push_back(false);
+	remaining.resize(distance.size());
+	lastAffected = 0;
+}
+
+
+void DynamicShortestPaths::on_node_removed(uint32_t handle, uint32_t movedFrom) {
+
+	// The node's edges are already gone, so only losing the source changes any distance.
+	if (handle == source) {
+		std::fill(distance.begin(), distance.end(), INFINITY);
+		std::fill(previous.begin(), previous.end(), NULL_HANDLE);
+		source = NULL_HANDLE;
+	}
+	if (movedFrom != handle) {
+		distance[handle] = distance[movedFrom];
+		previous[handle] = previous[movedFrom] == movedFrom ? handle : previous[movedFrom];
+		if (source == movedFrom) { source = handle; }
+		// Tree edges leave the moved node through its children, which still name its old handle.
+		graph->for_each_neighbor(handle, [this, handle, movedFrom](uint32_t child, double) {
+			if (previous[child] == movedFrom) { previous[child] = handle; }
+		});
+	}
+	distance.pop_back();
+	previous.pop_back();
+	affected.pop_back();
+	remaining.resize(distance.size());
+	lastAffected = 0;
+}
+
+
+void DynamicShortestPaths::on_edge_added(uint32_t parent, uint32_t child, double weight) {
+
+	lastAffected = 0;
+	double routedWeight = distance[parent] + weight;
+	if (!(routedWeight < distance[child])) { return; }
+	distance[child] = routedWeight;
+	previous[child] = parent;
+	remaining.push(child, routedWeight);
+	lastAffected = propagate();
+}
+
+
+void DynamicShortestPaths::on_edge_removed(uint32_t parent, uint32_t child, double) {
+
+	lastAffected = 0;
+	if (child == source || previous[child] != parent) { return; }
+
+	// Everything below child in the tree loses its route; nothing else does.
+	subtree.clear();
+	subtree.push_back(child);
+	affected[child] = true;
+	for (size_t i = 0; i < subtree.size(); i++) {
+		uint32_t curr = subtree[i];
+		graph->for_each_neighbor(curr, [this, curr](uint32_t next, double) {
+			if (!affected[next] && previous[next] == curr) {
+				affected[next] = true;
+				subtree.push_back(next);
+			}
+		});
+	}
+	for (uint32_t node : subtree) {
+		distance[node] = INFINITY;
+		previous[node] = NULL_HANDLE;
+	}
+
+	// Seed each cut node with its best way in from outside the subtree, then let Dijkstra settle
+	// the subtree. Distances outside it cannot drop, since every cut node only got farther away.
+	for (uint32_t node : subtree) {
+		graph->for_each_neighbor(node, [this, node](uint32_t from, double weight) {
+			if (!affected[from] && distance[from] + weight < distance[node]) {
+				distance[node] = distance[from] + weight;
+				previous[node] = from;
+			}
+		}, true);
+		if (distance[node] != INFINITY) { remaining.push(node, distance[node]); }
+	}
+	propagate();
+
+	for (uint32_t node : subtree) {
+		affected[node] = false;
+	}
+	lastAffected = subtree.size();
+}
+
+
+size_t DynamicShortestPaths::propagate() {
+
+	size_t settled = 0;
+	while (!remaining.is_empty()) {
+		uint32_t curr = remaining.pop();
+		settled++;
+		double currWeight = distance[curr];
+		graph->for_each_neighbor(curr, [this, curr, currWeight](uint32_t child, double weight) {
+			double routedWeight = currWeight + weight;
+			if (routedWeight < distance[child]) {
+				distance[child] = routedWeight;
+				previous[child] = curr;
+				remaining.push_or_decrease(child, routedWeight);
+			}
+		});
+	}
+	return settled;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "graph.h"
+#include "../indexed_heap.h"
+#include <vector>
+#include <cstdint>
+
+/* Single source shortest path tree that stays current while its Graph changes, in the manner of
+Ramalingam and Reps. It subscribes to the graph and repairs itself on every edge or node change,
+doing work proportional to the part of the tree the change affects rather than to the graph.
+
+An inserted edge that shortens its child's distance starts a Dijkstra that only spreads while
+distances keep dropping. A removed edge only matters if it is a tree edge; then the subtree
+below it is cut loose, each of its nodes is seeded with the best distance through a parent
+outside the subtree, and a Dijkstra restricted to the subtree settles the rest.
+
+Updates run on the thread that changes the graph, so the graph must not be changed from
+several threads at once. */
+class DynamicShortestPaths : public GraphListener {
+
+public:
+
+	Graph* graph;
+	uint32_t source;
+	// Indexed by handle; unreached nodes are at INFINITY with a NULL_HANDLE previous.
+	std::vector<double> distance;
+	std::vector<uint32_t> previous;
+	// Number of nodes whose distance was reconsidered by the most recent update.
+	size_t lastAffected = 0;
+
+protected:
+
+	IndexedHeap<4> remaining;
+	// Marks the subtree cut loose by a removed tree edge while it is being repaired.
+	std::vector<bool> affected;
+	std::vector<uint32_t> subtree;
+
+public:
+
+	DynamicShortestPaths(Graph& graph, uint32_t source);
+
+
+	DynamicShortestPaths(Graph& graph, const std::string& sourceId);
+
+
+	~DynamicShortestPaths();
+
+
+	// Fills path from the source to handle and returns its weight, or INFINITY with an empty path.
+	double get_path(uint32_t handle, std::vector<uint32_t>& path) const;
+
+
+	void on_node_added(uint32_t handle) override;
+
+
+	void on_node_removed(uint32_t handle, uint32_t movedFrom) override;
+
+
+	void on_edge_added(uint32_t parent, uint32_t child, double weight) override;
+
+
+	void on_edge_removed(uint32_t parent, uint32_t child, double weight) override;
+
+protected:
+
+	// Dijkstra from whatever is queued, only ever lowering distances. Returns the nodes settled.
+	size_t propagate();
+};
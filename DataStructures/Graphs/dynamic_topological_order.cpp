@@ -0,0 +1,137 @@
+#include "dynamic_topological_order.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+
+DynamicTopologicalOrder::DynamicTopologicalOrder(Graph& graph, size_t threads) : graph(&graph) {
+
+	std::vector<uint32_t> levelOffsets, cycle;
+	if (!graph.topological_levels(order, levelOffsets, &cycle, threads)) {
+		std::cerr << "Topological order not built: Graph has a cycle through <"
+			<< graph.get_id(cycle.front()) << ">." << std::endl;
+		throw std::invalid_argument("Graph has a cycle.");
+	}
+	position.resize(order.size());
+	for (uint32_t i = 0; i < order.size(); i++) {
+		position[order[i]] = i;
+	}
+	mark.assign(order.size(), 0);
+	graph.add_listener(this);
+}
+
+
+DynamicTopologicalOrder::~DynamicTopologicalOrder() {
+	graph->remove_listener(this);
+}
+
+
+bool DynamicTopologicalOrder::precedes(uint32_t u, uint32_t v) const {
+
+	if (u >= position.size() || v >= position.size()) {
+		std::cerr << "Order not compared: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	return position[u] < position[v];
+}
+
+
+void DynamicTopologicalOrder::on_node_added(uint32_t handle) {
+	position.push_back(static_cast<uint32_t>(order.size()));
+	order.push_back(handle);
+	mark.push_back(0);
+	lastAffected = 0;
+}
+
+
+void DynamicTopologicalOrder::on_node_removed(uint32_t handle, uint32_t movedFrom) {
+
+	uint32_t slot = position[handle];
+	order.erase(order.begin() + slot);
+	for (uint32_t i = slot; i < order.size(); i++) {
+		position[order[i]] = i;
+	}
+	if (movedFrom != handle) {
+		position[handle] = position[movedFrom];
+		order[position[handle]] = handle;
+	}
+	position.pop_back();
+	mark.pop_back();
+	lastAffected = 0;
+}
+
+
+void DynamicTopologicalOrder::before_edge_added(uint32_t parent, uint32_t child) {
+
+	lastAffected = 0;
+	uint32_t lower = position[child], upper = position[parent];
+	if (lower > upper) { return; }
+
+	// The two searches cannot meet: a node both reached from child and reaching parent would
+	// put parent in the forward set, which is the cycle case.
+	next_stamp();
+	forward.clear();
+	backward.clear();
+	if (!bounded_search(child, false, lower, upper, parent, forward)) {
+		std::cerr << "Edge not created: <" << graph->get_id(parent) << "> to <" << graph->get_id(child)
+			<< "> would close a cycle." << std::endl;
+		throw std::invalid_argument("Edge would create a cycle.");
+	}
+	bounded_search(parent, true, lower, upper, NULL_HANDLE, backward);
+
+	// Refill the positions both sets held, ancestors of parent first, keeping each set's
+	// internal order.
+	auto byPosition = [this](uint32_t a, uint32_t b) { return position[a] < position[b]; };
+	std::sort(forward.begin(), forward.end(), byPosition);
+	std::sort(backward.begin(), backward.end(), byPosition);
+	slots.clear();
+	for (uint32_t v : backward) {
+		slots.push_back(position[v]);
+	}
+	for (uint32_t v : forward) {
+		slots.push_back(position[v]);
+	}
+	std::sort(slots.begin(), slots.end());
+	size_t next = 0;
+	for (uint32_t v : backward) {
+		position[v] = slots[next++];
+		order[position[v]] = v;
+	}
+	for (uint32_t v : forward) {
+		position[v] = slots[next++];
+		order[position[v]] = v;
+	}
+	lastAffected = slots.size();
+}
+
+
+bool DynamicTopologicalOrder::bounded_search(uint32_t start, bool parents, uint32_t lower, uint32_t upper,
+	uint32_t stop, std::vector<uint32_t>& found) {
+
+	if (start == stop) { return false; }
+	mark[start] = stamp;
+	stack.assign(1, start);
+	while (!stack.empty()) {
+		uint32_t curr = stack.back();
+		stack.pop_back();
+		found.push_back(curr);
+		bool reachedStop = false;
+		graph->for_each_neighbor(curr, [&](uint32_t next, double) {
+			if (next == stop) { reachedStop = true; }
+			if (mark[next] != stamp && position[next] >= lower && position[next] <= upper) {
+				mark[next] = stamp;
+				stack.push_back(next);
+			}
+		}, parents);
+		if (reachedStop) { return false; }
+	}
+	return true;
+}
+
+
+void DynamicTopologicalOrder::next_stamp() {
+	if (++stamp == 0) {
+		std::fill(mark.begin(), mark.end(), 0);
+		stamp = 1;
+	}
+}
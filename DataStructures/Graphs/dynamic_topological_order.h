@@ -0,0 +1,65 @@
+#pragma once
+#include "graph.h"
+#include <vector>
+#include <cstdint>
+
+/* Topological order of a DAG that stays current while edges are inserted one at a time, using
+the algorithm of Pearce and Kelly. It subscribes to the graph and checks every new edge before
+it is linked in. An edge that already agrees with the order costs O(1). Otherwise only the nodes
+whose positions lie between the edge's two ends are searched: those reachable from the child and
+those reaching the parent. Those two sets trade places within the positions they already use,
+and nothing else moves. If the child's search reaches the parent, the edge would close a cycle,
+so it is rejected with an exception before the graph changes.
+
+Removing edges never invalidates an order, so removals cost nothing. Updates run on the thread
+that changes the graph, so the graph must not be changed from several threads at once. */
+class DynamicTopologicalOrder : public GraphListener {
+
+public:
+
+	Graph* graph;
+	// order[i] is the handle at position i, and position[handle] is its index in order. Every
+	// edge leads from a lower position to a higher one.
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> position;
+	// Number of nodes moved by the most recent edge insertion.
+	size_t lastAffected = 0;
+
+protected:
+
+	// Epoch stamps marking the nodes each search has reached, so marks never need clearing.
+	std::vector<uint32_t> mark;
+	uint32_t stamp = 0;
+	std::vector<uint32_t> stack, forward, backward, slots;
+
+public:
+
+	/* Throws if the graph already has a cycle. Zero threads means one per hardware thread. */
+	DynamicTopologicalOrder(Graph& graph, size_t threads = 0);
+
+
+	~DynamicTopologicalOrder();
+
+
+	// True if u comes before v in the current order, as it must when there is a path from u to v.
+	bool precedes(uint32_t u, uint32_t v) const;
+
+
+	void on_node_added(uint32_t handle) override;
+
+
+	void on_node_removed(uint32_t handle, uint32_t movedFrom) override;
+
+
+	void before_edge_added(uint32_t parent, uint32_t child) override;
+
+protected:
+
+	// Collects into found every node reachable from start, over children (or parents) whose
+	// positions stay within [lower, upper]. Returns false as soon as it reaches stop.
+	bool bounded_search(uint32_t start, bool parents, uint32_t lower, uint32_t upper, uint32_t stop,
+		std::vector<uint32_t>& found);
+
+
+	void next_stamp();
+};
@@ -1,5 +1,9 @@
 ﻿#include "graph.h"
-#include "binary_heap.h"
+#include <cmath>
+#include <bit>
+#include <algorithm>
+#include <queue>
+#include <set>
 extern int graphIds = 0x000000;
 
 Graph::Graph(const std::string& title, bool weighted) {
@@ -106,6 +110,41 @@ bool Graph::exists_node(const std::string& id) const {
 };
 
 
+uint32_t Graph::get_handle(const std::string& id) const {
+	GraphNode* node = get_node(id);
+	if (!node) {
+		return NULL_HANDLE;
+	}
+	return node->handle;
+};
+
+
+std::string Graph::get_id(uint32_t handle) const {
+	GraphNode* node = get_handle_node(handle);
+	if (!node) {
+		std::cerr << "Handle " << handle << " does not belong to a node." << std::endl;
+		throw std::invalid_argument("Handle does not belong to a node.");
+	}
+	return node->id.to_string();
+};
+
+
+size_t Graph::handle_count() const {
+	return this->handles.size();
+};
+
+
+void Graph::add_listener(GraphListener* listener) {
+	this->listeners.push_back(listener);
+};
+
+
+void Graph::remove_listener(GraphListener* listener) {
+	this->listeners.erase(std::remove(this->listeners.begin(), this->listeners.end(), listener),
+		this->listeners.end());
+};
+
+
 void Graph::check_make_edge(const std::string& parent, const std::string& child,
 	double parent_to_child_weight) {
 	if (parent_to_child_weight == -1) {
@@ -135,18 +174,28 @@ void Graph::make_edge(const std::string& parent, const std::string& child,
 
 	check_make_edge(parent, child, parent_to_child_weight);
 
-	GraphNode* parentNode = get_node(parent);
-	GraphNode* childNode = get_node(child);
+	connect_nodes(get_node(parent), get_node(child), parent_to_child_weight);
+};
+
 
-	Neighbor<GraphNode>* parentNeighbor = create_neighbor(childNode, parent_to_child_weight);
-	Neighbor<GraphNode>* childNeighbor = create_neighbor(parentNode, parent_to_child_weight);
+void Graph::make_edge(uint32_t parent, uint32_t child, double parent_to_child_weight) {
 
-	if (!parentNode->children->contains_id(*parentNeighbor->id)) {
-		parentNode->children->append(*parentNeighbor);
+	validate_weight(parent_to_child_weight != -1);
+	if (parent_to_child_weight != -1 && parent_to_child_weight < 0) {
+		std::cerr << "Weight must be positive." << std::endl;
+		return;
 	}
-	if (!childNode->parents->contains_id(*childNeighbor->id)) {
-		childNode->parents->append(*childNeighbor);
+	GraphNode* parentNode = get_handle_node(parent);
+	GraphNode* childNode = get_handle_node(child);
+	if (!parentNode) {
+		std::cerr << "Edge not created: Parent node does not exist." << std::endl;
+		throw std::invalid_argument("Parent node does not exist.");
 	}
+	if (!childNode) {
+		std::cerr << "Edge not created: Child node does not exist." << std::endl;
+		throw std::invalid_argument("Child node does not exist.");
+	}
+	connect_nodes(parentNode, childNode, parent_to_child_weight);
 };
 
 
@@ -248,7 +297,15 @@ void Graph::insert(const std::string& parentId, const std::string& childId, doub
 void Graph::remove_edge(const std::string& parentId, const std::string& childId) {
 	GraphNode* parent = get_node(parentId), * child = get_node(childId);
 	if (parent && child) {
-		remove_edge(parent->id, child->id);
+		disconnect_nodes(parent, child);
+	}
+};
+
+
+void Graph::remove_edge(uint32_t parentHandle, uint32_t childHandle) {
+	GraphNode* parent = get_handle_node(parentHandle), * child = get_handle_node(childHandle);
+	if (parent && child) {
+		disconnect_nodes(parent, child);
 	}
 };
 
@@ -299,6 +356,13 @@ void Graph::depth_first_search(const std::string& startId, std::vector<std::stri
 };
 
 
+void Graph::depth_first_search(uint32_t startHandle, std::vector<uint32_t>& memo, callType func) {
+	callType funcPtr = func ? func : doNothing;
+	depth_first_search(startHandle, memo,
+		[this, funcPtr](uint32_t handle) { return funcPtr(this->handles[handle]->id.to_string()); });
+};
+
+
 void Graph::breadth_first_search(const std::string& startId, std::vector<std::string>& memo,
 	callType func) {
 
@@ -325,6 +389,102 @@ void Graph::breadth_first_search(const std::string& startId, std::vector<std::st
 };
 
 
+void Graph::breadth_first_search(uint32_t startHandle, std::vector<uint32_t>& memo, callType func) {
+	callType funcPtr = func ? func : doNothing;
+	breadth_first_search(startHandle, memo,
+		[this, funcPtr](uint32_t handle) { return funcPtr(this->handles[handle]->id.to_string()); });
+};
+
+
+void Graph::parallel_breadth_first_search(uint32_t startHandle, std::vector<uint32_t>& parent,
+	std::vector<uint32_t>& distance, size_t threads) {
+
+	if (!get_handle_node(startHandle)) {
+		std::cerr << "Start node does not exist." << std::endl;
+		throw std::invalid_argument("Start node does not exist.");
+	}
+	// Switching thresholds from Beamer, Asanovic and Patterson's direction-optimizing BFS.
+	const size_t ALPHA = 14, BETA = 24;
+
+	size_t N = this->handles.size();
+	parent.assign(N, NULL_HANDLE);
+	distance.assign(N, NULL_HANDLE);
+	ThreadPool pool(threads);
+	AtomicBitmap visited(N);
+
+	size_t unexploredEdges = 0;
+	for (GraphNode* node : this->handles) {
+		unexploredEdges += node->children->size;
+	}
+	visited.set(startHandle);
+	parent[startHandle] = startHandle;
+	distance[startHandle] = 0;
+
+	std::vector<uint32_t> frontier{ startHandle }, next;
+	size_t frontierEdges = this->handles[startHandle]->children->size;
+	unexploredEdges -= frontierEdges;
+	bool bottomUp = false;
+	uint32_t level = 0;
+
+	while (!frontier.empty()) {
+		if (!bottomUp && frontierEdges > unexploredEdges / ALPHA) {
+			bottomUp = true;
+		}
+		else if (bottomUp && frontier.size() < N / BETA) {
+			bottomUp = false;
+		}
+		next.clear();
+		frontierEdges = bottomUp
+			? bottom_up_step(pool, frontier, next, visited, parent, distance, level)
+			: top_down_step(pool, frontier, next, visited, parent, distance, level);
+		unexploredEdges -= frontierEdges;
+		frontier.swap(next);
+		level++;
+	}
+};
+
+
+void Graph::multi_source_breadth_first_search(const std::vector<uint32_t>& startHandles,
+	std::vector<std::vector<uint32_t>>& distances) {
+
+	for (uint32_t start : startHandles) {
+		if (!get_handle_node(start)) {
+			std::cerr << "Start node does not exist." << std::endl;
+			throw std::invalid_argument("Start node does not exist.");
+		}
+	}
+	distances.assign(startHandles.size(), std::vector<uint32_t>(this->handles.size(), NULL_HANDLE));
+	for (size_t first = 0; first < startHandles.size(); first += MS_BFS_WIDTH) {
+		size_t batchSize = startHandles.size() - first;
+		if (batchSize > MS_BFS_WIDTH) { batchSize = MS_BFS_WIDTH; }
+		multi_source_batch(startHandles, first, batchSize, distances);
+	}
+};
+
+
+void Graph::multi_source_breadth_first_search(const std::vector<std::string>& startIds,
+	std::vector<std::vector<uint32_t>>& distances) {
+
+	std::vector<uint32_t> startHandles;
+	for (const std::string& id : startIds) {
+		if (!get_node(id)) {
+			std::cerr << "Start node <" << id << "> does not exist." << std::endl;
+			throw std::invalid_argument("Start node does not exist.");
+		}
+		startHandles.push_back(get_handle(id));
+	}
+	multi_source_breadth_first_search(startHandles, distances);
+};
+
+
+bool Graph::multi_directional_search(const std::vector<uint32_t>& startHandles,
+	std::vector<std::vector<uint32_t>>& paths, callType func) {
+	callType funcPtr = func ? func : doNothing;
+	return multi_directional_search(startHandles, paths,
+		[this, funcPtr](uint32_t handle) { return funcPtr(this->handles[handle]->id.to_string()); });
+};
+
+
 void Graph::post_order_depth_first_search(const std::string& startId,
 	std::vector<std::string>& memo) {
 
@@ -346,15 +506,16 @@ void Graph::post_order_depth_first_search(const std::string& startId,
 };
 
 
-/* Searches the nodes depth first, picking a node to start at and finding its further parent,
-then starting the traversal from there. Repeats until all nodes are traversed. */
+/* Searches the nodes depth first, one tree per unvisited root, until all nodes are traversed.
+Nodes without parents are tried as roots first, then every other node, each in handle order,
+so the whole forest takes O(V + E). Each inner list holds the nodes first reached from one root. */
 void Graph::forest_depth_first_search(std::vector<std::vector<std::string>>& memo,
 	callType func) {
 
 	std::cout << "\nBeginning forested depth first search..." << std::endl;
 	SmartList<SmartList<String>>* memoList = \
 		new SmartList<SmartList<String>>;
-	forest_depth_first_search(memoList);
+	forest_depth_first_search(memoList, func);
 
 	DNode<SmartList<String>>* ptr = memoList->head;
 	while (ptr) {
@@ -419,6 +580,176 @@ void Graph::topological_sort(std::string(&memo)[]) {
 };
 
 
+bool Graph::topological_levels(std::vector<uint32_t>& order, std::vector<uint32_t>& levelOffsets,
+	std::vector<uint32_t>* cycle, size_t threads) const {
+
+	size_t N = this->handles.size();
+	// A single thread runs each range inline rather than paying to start a pool it won't use.
+	std::unique_ptr<ThreadPool> pool(threads == 1 ? nullptr : new ThreadPool(threads));
+	auto for_range = [&pool](size_t begin, size_t end, auto body) {
+		if (pool) {
+			pool->parallel_for(begin, end, body);
+		}
+		else if (begin < end) {
+			body(begin, end, 0);
+		}
+	};
+	std::unique_ptr<std::atomic<uint32_t>[]> liveParents(new std::atomic<uint32_t>[N]);
+	std::vector<std::vector<uint32_t>> found(pool ? pool->size : 1);
+	order.clear();
+	levelOffsets.assign(1, 0);
+	if (cycle) { cycle->clear(); }
+
+	for_range(0, N, [&](size_t begin, size_t end, size_t worker) {
+		for (size_t v = begin; v < end; v++) {
+			uint32_t parents = static_cast<uint32_t>(this->handles[v]->parents->size);
+			liveParents[v].store(parents, std::memory_order_relaxed);
+			if (!parents) { found[worker].push_back(static_cast<uint32_t>(v)); }
+		}
+	});
+
+	while (true) {
+		size_t levelStart = order.size();
+		for (std::vector<uint32_t>& part : found) {
+			order.insert(order.end(), part.begin(), part.end());
+			part.clear();
+		}
+		if (order.size() == levelStart) { break; }
+		// Workers finish in any order, so each level is sorted to keep the result deterministic.
+		std::sort(order.begin() + levelStart, order.end());
+		levelOffsets.push_back(static_cast<uint32_t>(order.size()));
+
+		// Whoever takes a child's count of unplaced parents to zero puts it in the next level.
+		for_range(levelStart, order.size(), [&](size_t begin, size_t end, size_t worker) {
+			for (size_t i = begin; i < end; i++) {
+				DNode<Neighbor<GraphNode>>* childPtr = this->handles[order[i]]->children->head;
+				for (; childPtr; childPtr = childPtr->next) {
+					uint32_t child = childPtr->data->node->handle;
+					if (liveParents[child].fetch_sub(1, std::memory_order_relaxed) == 1) {
+						found[worker].push_back(child);
+					}
+				}
+			}
+		});
+	}
+	if (order.size() == N) { return true; }
+	if (!cycle) { return false; }
+
+	// Every unplaced node has an unplaced parent, so walking up through them from any one of
+	// them must come back to a node already walked; the walk from there on is a cycle.
+	uint32_t curr = 0;
+	while (!liveParents[curr].load(std::memory_order_relaxed)) { curr++; }
+	std::vector<uint32_t> walk, position(N, NULL_HANDLE);
+	while (position[curr] == NULL_HANDLE) {
+		position[curr] = static_cast<uint32_t>(walk.size());
+		walk.push_back(curr);
+		DNode<Neighbor<GraphNode>>* parentPtr = this->handles[curr]->parents->head;
+		while (!liveParents[parentPtr->data->node->handle].load(std::memory_order_relaxed)) {
+			parentPtr = parentPtr->next;
+		}
+		curr = parentPtr->data->node->handle;
+	}
+	cycle->assign(walk.rbegin(), walk.rend() - position[curr]);
+	return false;
+}
+
+
+Generator<uint32_t> Graph::bfs(uint32_t startHandle) const {
+	if (!get_handle_node(startHandle)) {
+		std::cerr << "Start node does not exist." << std::endl;
+		throw std::invalid_argument("Start node does not exist.");
+	}
+	return bfs_from(startHandle);
+};
+
+
+Generator<uint32_t> Graph::bfs(const std::string& startId) const {
+	return bfs(get_handle(startId));
+};
+
+
+Generator<uint32_t> Graph::dfs(uint32_t startHandle) const {
+	if (!get_handle_node(startHandle)) {
+		std::cerr << "Start node does not exist." << std::endl;
+		throw std::invalid_argument("Start node does not exist.");
+	}
+	return dfs_from(startHandle);
+};
+
+
+Generator<uint32_t> Graph::dfs(const std::string& startId) const {
+	return dfs(get_handle(startId));
+};
+
+
+Generator<uint32_t> Graph::topo() const {
+
+	size_t N = this->handles.size();
+	std::vector<uint32_t> liveParents(N), queue;
+	for (uint32_t v = 0; v < N; v++) {
+		liveParents[v] = static_cast<uint32_t>(this->handles[v]->parents->size);
+		if (!liveParents[v]) { queue.push_back(v); }
+	}
+	for (size_t head = 0; head < queue.size(); head++) {
+		uint32_t curr = queue[head];
+		co_yield curr;
+		DNode<Neighbor<GraphNode>>* childPtr = this->handles[curr]->children->head;
+		for (; childPtr; childPtr = childPtr->next) {
+			uint32_t child = childPtr->data->node->handle;
+			if (!--liveParents[child]) { queue.push_back(child); }
+		}
+	}
+	if (queue.size() != N) {
+		std::cerr << "Topological order stopped: Graph has a cycle." << std::endl;
+		throw std::invalid_argument("Graph has a cycle.");
+	}
+};
+
+
+Generator<uint32_t> Graph::bfs_from(uint32_t startHandle) const {
+
+	std::vector<bool> seen(this->handles.size(), false);
+	std::vector<uint32_t> queue(1, startHandle);
+	seen[startHandle] = true;
+	co_yield startHandle;
+	for (size_t head = 0; head < queue.size(); head++) {
+		DNode<Neighbor<GraphNode>>* childPtr = this->handles[queue[head]]->children->head;
+		for (; childPtr; childPtr = childPtr->next) {
+			uint32_t child = childPtr->data->node->handle;
+			if (seen[child]) { continue; }
+			seen[child] = true;
+			queue.push_back(child);
+			co_yield child;
+		}
+	}
+};
+
+
+Generator<uint32_t> Graph::dfs_from(uint32_t startHandle) const {
+
+	std::vector<bool> seen(this->handles.size(), false);
+	std::vector<DNode<Neighbor<GraphNode>>*> childStack;
+	seen[startHandle] = true;
+	co_yield startHandle;
+	childStack.push_back(this->handles[startHandle]->children->head);
+
+	while (!childStack.empty()) {
+		DNode<Neighbor<GraphNode>>* childPtr = childStack.back();
+		if (!childPtr) {
+			childStack.pop_back();
+			continue;
+		}
+		childStack.back() = childPtr->next;
+
+		uint32_t child = childPtr->data->node->handle;
+		if (seen[child]) { continue; }
+		seen[child] = true;
+		co_yield child;
+		childStack.push_back(this->handles[child]->children->head);
+	}
+};
+
+
 /* Transposes the graph in-place. */
 void Graph::transpose() {
 
@@ -462,6 +793,334 @@ void Graph::kosarajus_algorithm(std::vector<std::vector<std::string>>& memo) {
 };
 
 
+size_t Graph::strongly_connected_components(std::vector<uint32_t>& component, std::vector<uint32_t>& offsets,
+	std::vector<uint32_t>& members, const std::atomic<bool>* cancelled) const {
+
+	size_t N = this->handles.size();
+	// rindex is 0 for unvisited nodes, the visit index while a node is open and its label, counted
+	// down from N, once closed. Indices of closed nodes are handed back, so open indices always
+	// stay below closed labels.
+	std::vector<uint32_t> rindex(N, 0);
+	std::vector<bool> root(N, false);
+	std::vector<std::pair<uint32_t, DNode<Neighbor<GraphNode>>*>> calls;
+	std::vector<uint32_t> open;
+	uint32_t index = 1, label = static_cast<uint32_t>(N);
+	auto stop = [&]() {
+		if (!cancelled || !cancelled->load(std::memory_order_relaxed)) { return false; }
+		component.clear();
+		offsets.clear();
+		members.clear();
+		return true;
+	};
+
+	for (uint32_t start = 0; start < N; start++) {
+		if (rindex[start]) { continue; }
+		if (stop()) { return 0; }
+		rindex[start] = index++;
+		root[start] = true;
+		calls.push_back({ start, this->handles[start]->children->head });
+
+		while (!calls.empty()) {
+			uint32_t v = calls.back().first;
+			DNode<Neighbor<GraphNode>>*& child = calls.back().second;
+			if (child) {
+				uint32_t w = child->data->node->handle;
+				child = child->next;
+				if (!rindex[w]) {
+					if (stop()) { return 0; }
+					rindex[w] = index++;
+					root[w] = true;
+					calls.push_back({ w, this->handles[w]->children->head });
+				}
+				else if (rindex[w] < rindex[v]) {
+					rindex[v] = rindex[w];
+					root[v] = false;
+				}
+				continue;
+			}
+
+			calls.pop_back();
+			if (root[v]) {
+				index--;
+				while (!open.empty() && rindex[v] <= rindex[open.back()]) {
+					rindex[open.back()] = label;
+					open.pop_back();
+					index--;
+				}
+				rindex[v] = label--;
+			}
+			else {
+				open.push_back(v);
+			}
+			if (!calls.empty()) {
+				uint32_t parent = calls.back().first;
+				if (rindex[v] < rindex[parent]) {
+					rindex[parent] = rindex[v];
+					root[parent] = false;
+				}
+			}
+		}
+	}
+
+	size_t componentCount = N - label;
+	component.assign(N, 0);
+	for (uint32_t v = 0; v < N; v++) {
+		component[v] = static_cast<uint32_t>(N - rindex[v]);
+	}
+	group_components(component, componentCount, offsets, members);
+	return componentCount;
+}
+
+
+void Graph::strongly_connected_components(std::vector<std::vector<std::string>>& components) const {
+
+	std::vector<uint32_t> component, offsets, members;
+	size_t componentCount = strongly_connected_components(component, offsets, members);
+	components.assign(componentCount, std::vector<std::string>());
+	for (size_t c = 0; c < componentCount; c++) {
+		for (uint32_t i = offsets[c]; i < offsets[c + 1]; i++) {
+			components[c].push_back(this->handles[members[i]]->id.to_string());
+		}
+	}
+}
+
+
+size_t Graph::parallel_strongly_connected_components(std::vector<uint32_t>& component,
+	std::vector<uint32_t>& offsets, std::vector<uint32_t>& members, size_t threads) const {
+
+	size_t N = this->handles.size();
+	ThreadPool pool(threads);
+	AtomicBitmap done(N);
+	std::atomic<uint32_t> componentCount(0);
+	std::vector<uint32_t> inDegree(N), outDegree(N);
+	component.assign(N, NULL_HANDLE);
+
+	trim_components(pool, done, component, componentCount, inDegree, outDegree);
+
+	// Forward-backward from the likeliest member of the giant component.
+	uint32_t pivot = NULL_HANDLE;
+	uint64_t pivotScore = 0;
+	for (uint32_t v = 0; v < N; v++) {
+		uint64_t score = uint64_t(inDegree[v]) * outDegree[v];
+		if (!done.test(v) && (pivot == NULL_HANDLE || score > pivotScore)) {
+			pivot = v;
+			pivotScore = score;
+		}
+	}
+	if (pivot != NULL_HANDLE) {
+		AtomicBitmap forward(N), backward(N);
+		restricted_reach(pool, pivot, false, done, forward);
+		restricted_reach(pool, pivot, true, done, backward);
+		uint32_t label = componentCount++;
+		pool.parallel_for(0, N, [&](size_t begin, size_t end, size_t) {
+			for (size_t v = begin; v < end; v++) {
+				if (forward.test(v) && backward.test(v)) {
+					component[v] = label;
+					done.set(v);
+				}
+			}
+		});
+		trim_components(pool, done, component, componentCount, inDegree, outDegree);
+	}
+
+	std::unique_ptr<std::atomic<uint32_t>[]> color(new std::atomic<uint32_t>[N]);
+	std::vector<uint32_t> live, frontier;
+	while (true) {
+		live.clear();
+		for (uint32_t v = 0; v < N; v++) {
+			if (!done.test(v)) { live.push_back(v); }
+		}
+		if (live.empty()) { break; }
+
+		// Spread the largest handle forward until no color changes.
+		for (uint32_t v : live) {
+			color[v].store(v, std::memory_order_relaxed);
+		}
+		frontier = live;
+		while (!frontier.empty()) {
+			AtomicBitmap queued(N);
+			std::vector<std::vector<uint32_t>> found(pool.size);
+			pool.parallel_for(0, frontier.size(), [&](size_t begin, size_t end, size_t worker) {
+				for (size_t i = begin; i < end; i++) {
+					uint32_t c = color[frontier[i]].load(std::memory_order_relaxed);
+					DNode<Neighbor<GraphNode>>* childPtr = this->handles[frontier[i]]->children->head;
+					while (childPtr) {
+						uint32_t child = childPtr->data->node->handle;
+						if (!done.test(child)) {
+							uint32_t curr = color[child].load(std::memory_order_relaxed);
+							bool raised = false;
+							while (curr < c && !(raised = color[child].compare_exchange_weak(curr, c,
+								std::memory_order_relaxed))) {}
+							if (raised && queued.set(child)) { found[worker].push_back(child); }
+						}
+						childPtr = childPtr->next;
+					}
+				}
+			});
+			frontier.clear();
+			for (std::vector<uint32_t>& part : found) {
+				frontier.insert(frontier.end(), part.begin(), part.end());
+			}
+		}
+
+		// A node keeping its own color roots a component: the nodes of that color it reaches
+		// backward. Colors are disjoint, so every root can search at once.
+		std::vector<uint32_t> roots;
+		for (uint32_t v : live) {
+			if (color[v].load(std::memory_order_relaxed) == v) { roots.push_back(v); }
+		}
+		pool.parallel_for(0, roots.size(), [&](size_t begin, size_t end, size_t) {
+			std::vector<uint32_t> stack;
+			for (size_t i = begin; i < end; i++) {
+				uint32_t root = roots[i];
+				uint32_t label = componentCount++;
+				component[root] = label;
+				done.set(root);
+				stack.push_back(root);
+				while (!stack.empty()) {
+					uint32_t v = stack.back();
+					stack.pop_back();
+					DNode<Neighbor<GraphNode>>* parentPtr = this->handles[v]->parents->head;
+					while (parentPtr) {
+						uint32_t parent = parentPtr->data->node->handle;
+						if (color[parent].load(std::memory_order_relaxed) == root && done.set(parent)) {
+							component[parent] = label;
+							stack.push_back(parent);
+						}
+						parentPtr = parentPtr->next;
+					}
+				}
+			}
+		}, 1);
+		trim_components(pool, done, component, componentCount, inDegree, outDegree);
+	}
+
+	group_components(component, componentCount, offsets, members);
+	return componentCount;
+}
+
+
+void Graph::trim_components(ThreadPool& pool, AtomicBitmap& done, std::vector<uint32_t>& component,
+	std::atomic<uint32_t>& componentCount, std::vector<uint32_t>& inDegree, std::vector<uint32_t>& outDegree) const {
+
+	size_t N = this->handles.size();
+	std::unique_ptr<std::atomic<uint32_t>[]> liveParents(new std::atomic<uint32_t>[N]);
+	std::unique_ptr<std::atomic<uint32_t>[]> liveChildren(new std::atomic<uint32_t>[N]);
+	std::vector<std::vector<uint32_t>> found(pool.size);
+
+	pool.parallel_for(0, N, [&](size_t begin, size_t end, size_t) {
+		for (size_t v = begin; v < end; v++) {
+			uint32_t parents = 0, children = 0;
+			if (!done.test(v)) {
+				DNode<Neighbor<GraphNode>>* ptr = this->handles[v]->parents->head;
+				for (; ptr; ptr = ptr->next) {
+					parents += !done.test(ptr->data->node->handle);
+				}
+				for (ptr = this->handles[v]->children->head; ptr; ptr = ptr->next) {
+					children += !done.test(ptr->data->node->handle);
+				}
+			}
+			liveParents[v].store(parents, std::memory_order_relaxed);
+			liveChildren[v].store(children, std::memory_order_relaxed);
+		}
+	});
+	pool.parallel_for(0, N, [&](size_t begin, size_t end, size_t worker) {
+		for (size_t v = begin; v < end; v++) {
+			if (done.test(v)) { continue; }
+			if (!liveParents[v].load(std::memory_order_relaxed) || !liveChildren[v].load(std::memory_order_relaxed)) {
+				done.set(v);
+				found[worker].push_back(static_cast<uint32_t>(v));
+			}
+		}
+	});
+
+	std::vector<uint32_t> frontier;
+	while (true) {
+		frontier.clear();
+		for (std::vector<uint32_t>& part : found) {
+			frontier.insert(frontier.end(), part.begin(), part.end());
+			part.clear();
+		}
+		if (frontier.empty()) { break; }
+
+		// Removing a node can leave its children without live parents and its parents without
+		// live children; whoever takes a count to zero claims that node for the next round.
+		pool.parallel_for(0, frontier.size(), [&](size_t begin, size_t end, size_t worker) {
+			for (size_t i = begin; i < end; i++) {
+				uint32_t v = frontier[i];
+				component[v] = componentCount++;
+				DNode<Neighbor<GraphNode>>* ptr = this->handles[v]->children->head;
+				for (; ptr; ptr = ptr->next) {
+					uint32_t child = ptr->data->node->handle;
+					if (done.test(child)) { continue; }
+					if (liveParents[child].fetch_sub(1, std::memory_order_relaxed) == 1 && done.set(child)) {
+						found[worker].push_back(child);
+					}
+				}
+				for (ptr = this->handles[v]->parents->head; ptr; ptr = ptr->next) {
+					uint32_t parent = ptr->data->node->handle;
+					if (done.test(parent)) { continue; }
+					if (liveChildren[parent].fetch_sub(1, std::memory_order_relaxed) == 1 && done.set(parent)) {
+						found[worker].push_back(parent);
+					}
+				}
+			}
+		});
+	}
+
+	for (size_t v = 0; v < N; v++) {
+		inDegree[v] = liveParents[v].load(std::memory_order_relaxed);
+		outDegree[v] = liveChildren[v].load(std::memory_order_relaxed);
+	}
+}
+
+
+void Graph::restricted_reach(ThreadPool& pool, uint32_t start, bool parents, const AtomicBitmap& done,
+	AtomicBitmap& reached) const {
+
+	std::vector<uint32_t> frontier(1, start);
+	std::vector<std::vector<uint32_t>> found(pool.size);
+	reached.set(start);
+	while (!frontier.empty()) {
+		pool.parallel_for(0, frontier.size(), [&](size_t begin, size_t end, size_t worker) {
+			for (size_t i = begin; i < end; i++) {
+				GraphNode* node = this->handles[frontier[i]];
+				DNode<Neighbor<GraphNode>>* ptr = parents ? node->parents->head : node->children->head;
+				for (; ptr; ptr = ptr->next) {
+					uint32_t next = ptr->data->node->handle;
+					if (!done.test(next) && !reached.test(next) && reached.set(next)) {
+						found[worker].push_back(next);
+					}
+				}
+			}
+		});
+		frontier.clear();
+		for (std::vector<uint32_t>& part : found) {
+			frontier.insert(frontier.end(), part.begin(), part.end());
+			part.clear();
+		}
+	}
+}
+
+
+void Graph::group_components(const std::vector<uint32_t>& component, size_t componentCount,
+	std::vector<uint32_t>& offsets, std::vector<uint32_t>& members) {
+
+	offsets.assign(componentCount + 1, 0);
+	for (uint32_t label : component) {
+		offsets[label + 1]++;
+	}
+	for (size_t c = 0; c < componentCount; c++) {
+		offsets[c + 1] += offsets[c];
+	}
+	members.assign(component.size(), 0);
+	std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+	for (uint32_t v = 0; v < component.size(); v++) {
+		members[cursor[component[v]]++] = v;
+	}
+}
+
+
 void Graph::dijsktras_algorithm(const std::string& startId, std::map<std::string, std::string>& previous) {
 	std::cout << "\nBeginning Dijsktra's Algorithm sort..." << std::endl;
 	HashTable<String> previousHash{this->count};
@@ -479,35 +1138,642 @@ void Graph::dijsktras_algorithm(const std::string& startId, std::map<std::string
 };
 
 
-void Graph::shortest_path(const std::string& startId, const std::string endId, std::vector<std::string>& shortestPath, double& weight) {
-	SmartList<String>* lst = new SmartList<String>;
-	this->shortest_path(startId, endId, *lst, weight);
+size_t Graph::dijsktras_algorithm(uint32_t startHandle, std::vector<double>& distance,
+	std::vector<uint32_t>& previous, uint32_t targetHandle, bool reverse) {
+
+	if (!get_handle_node(startHandle)) {
+		std::cerr << "Start node does not exist." << std::endl;
+		throw std::invalid_argument("Start node does not exist.");
+	}
+	size_t N = this->handles.size();
+	distance.assign(N, INFINITY);
+	previous.assign(N, NULL_HANDLE);
+	IndexedHeap<4> remaining(N);
+
+	distance[startHandle] = 0;
+	previous[startHandle] = startHandle;
+	remaining.push(startHandle, 0);
+	size_t settled = 0;
+
+	while (!remaining.is_empty()) {
+		uint32_t curr = remaining.pop();
+		settled++;
+		if (curr == targetHandle) { break; }
+
+		double currWeight = distance[curr];
+		DNode<Neighbor<GraphNode>>* child = reverse
+			? this->handles[curr]->parents->head
+			: this->handles[curr]->children->head;
+		while (child) {
+			uint32_t childHandle = child->data->node->handle;
+			double routedWeight = currWeight + edge_weight(child->data);
+			if (routedWeight < distance[childHandle]) {
+				distance[childHandle] = routedWeight;
+				previous[childHandle] = curr;
+				remaining.push_or_decrease(childHandle, routedWeight);
+			}
+			child = child->next;
+		}
+	}
+	return settled;
+}
+
+
+void Graph::delta_stepping(uint32_t startHandle, std::vector<double>& distance, double delta,
+	size_t threads) {
+
+	if (!get_handle_node(startHandle)) {
+		std::cerr << "Start node does not exist." << std::endl;
+		throw std::invalid_argument("Start node does not exist.");
+	}
+	size_t N = this->handles.size();
+	if (delta <= 0) {
+		double total = 0;
+		size_t edges = 0;
+		for (GraphNode* node : this->handles) {
+			DNode<Neighbor<GraphNode>>* child = node->children->head;
+			while (child) {
+				total += edge_weight(child->data);
+				edges++;
+				child = child->next;
+			}
+		}
+		delta = edges && total > 0 ? total / edges : 1;
+	}
+
+	ThreadPool pool(threads);
+	std::unique_ptr<std::atomic<double>[]> atomicDistance(new std::atomic<double>[N]);
+	for (size_t i = 0; i < N; i++) {
+		atomicDistance[i].store(INFINITY, std::memory_order_relaxed);
+	}
+	atomicDistance[startHandle].store(0, std::memory_order_relaxed);
+
+	// A node can be filed in several buckets; only the bucket matching its current distance counts.
+	std::vector<std::vector<uint32_t>> buckets(1, std::vector<uint32_t>{ startHandle });
+	std::vector<std::vector<uint32_t>> found(pool.size);
+	std::vector<size_t> queuedRound(N, SIZE_MAX), settledBucket(N, SIZE_MAX);
+	std::vector<uint32_t> frontier, settled;
+	size_t round = 0;
+
+	auto file_found = [&]() {
+		for (std::vector<uint32_t>& local : found) {
+			for (uint32_t v : local) {
+				size_t bucket = static_cast<size_t>(atomicDistance[v].load(std::memory_order_relaxed) / delta);
+				if (bucket >= buckets.size()) { buckets.resize(bucket + 1); }
+				buckets[bucket].push_back(v);
+			}
+			local.clear();
+		}
+	};
+
+	for (size_t i = 0; i < buckets.size(); i++) {
+		settled.clear();
+		while (!buckets[i].empty()) {
+			round++;
+			frontier.clear();
+			for (uint32_t u : buckets[i]) {
+				size_t bucket = static_cast<size_t>(atomicDistance[u].load(std::memory_order_relaxed) / delta);
+				if (bucket != i || queuedRound[u] == round) { continue; }
+				queuedRound[u] = round;
+				frontier.push_back(u);
+				if (settledBucket[u] != i) {
+					settledBucket[u] = i;
+					settled.push_back(u);
+				}
+			}
+			buckets[i].clear();
+			relax_delta_edges(pool, frontier, atomicDistance.get(), delta, true, found);
+			file_found();
+		}
+		relax_delta_edges(pool, settled, atomicDistance.get(), delta, false, found);
+		file_found();
+	}
+
+	distance.resize(N);
+	for (size_t i = 0; i < N; i++) {
+		distance[i] = atomicDistance[i].load(std::memory_order_relaxed);
+	}
 }
 
 
-void Graph::shortest_path(const std::string& startId, const std::string endId, SmartList<String>& shortestPath, double& weight) {
-	HashTable<String> previousPath{};
-	this->dijsktras_algorithm(startId, previousPath);
-	String* curr = new String(endId);
+void Graph::relax_delta_edges(ThreadPool& pool, std::vector<uint32_t>& frontier, std::atomic<double>* distance,
+	double delta, bool light, std::vector<std::vector<uint32_t>>& found) {
+
+	pool.parallel_for(0, frontier.size(), [&](size_t begin, size_t end, size_t worker) {
+		for (size_t i = begin; i < end; i++) {
+			uint32_t u = frontier[i];
+			double currWeight = distance[u].load(std::memory_order_relaxed);
+			DNode<Neighbor<GraphNode>>* child = this->handles[u]->children->head;
+			while (child) {
+				double weight = edge_weight(child->data);
+				if ((weight <= delta) == light
+					&& atomic_min(distance[child->data->node->handle], currWeight + weight)) {
+					found[worker].push_back(child->data->node->handle);
+				}
+				child = child->next;
+			}
+		}
+	});
+}
 
-	while (curr->to_string() != "") {
-		shortestPath.append(*(new String(curr->to_string())));
-		if (curr->to_string() == startId) { break; }
-		curr = previousPath.get(curr->to_string());
+
+void Graph::shortest_path(const std::string& startId, const std::string endId, std::vector<std::string>& shortestPath, double& weight,
+	bool bidirectional) {
+	SmartList<String>* lst = new SmartList<String>;
+	this->shortest_path(startId, endId, *lst, weight, bidirectional);
+	DNode<String>* ptr = lst->head;
+	while (ptr) {
+		shortestPath.push_back(ptr->data->to_string());
+		ptr = ptr->next;
+	}
+}
+
+
+void Graph::shortest_path(const std::string& startId, const std::string endId, SmartList<String>& shortestPath, double& weight,
+	bool bidirectional) {
+	GraphNode* start = get_node(startId), * end = get_node(endId);
+	if (!start || !end) {
+		std::cerr << "Shortest path not found: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
 	}
-	weight = 0;
-	DNode<String>* weightCurr = shortestPath.head;
-	while (weightCurr->next) {
-		weight += get_node(*weightCurr->data)->parents->get_id(*weightCurr->next->data)->weight;
-		weightCurr = weightCurr->next;
+	if (bidirectional) {
+		std::vector<uint32_t> path;
+		weight = this->bidirectional_search(start->handle, end->handle, path);
+		for (uint32_t handle : path) {
+			shortestPath.append(this->handles[handle]->id);
+		}
+		std::cout << "Bidirectional Shortest Path from <" << startId << "> to <" << endId << "> in " << this->type
+			<< " <" << this->graphId << "> finished. Returned with{\nPath: "
+			<< shortestPath.to_string() << ", Weight: " << weight << "\n}\n" << std::endl;
+		return;
+	}
+	std::vector<double> distance;
+	std::vector<uint32_t> previous;
+	this->dijsktras_algorithm(start->handle, distance, previous, end->handle);
+
+	weight = distance[end->handle];
+	if (previous[end->handle] != NULL_HANDLE) {
+		uint32_t curr = end->handle;
+		while (true) {
+			shortestPath.append(this->handles[curr]->id);
+			if (curr == start->handle) { break; }
+			curr = previous[curr];
+		}
+		shortestPath.reverse();
 	}
-	shortestPath.reverse();
 	std::cout << "Shortest Path from <"<<startId << "> to <" <<endId << "> in " << this->type << " <" << this->graphId
 		<< "> finished. Returned with{\nPath: "
 		<< shortestPath.to_string() << ", Weight: " << weight << "\n}\n" << std::endl;
 }
 
 
+double Graph::bidirectional_search(uint32_t startHandle, uint32_t endHandle, std::vector<uint32_t>& path,
+	size_t* settled) {
+
+	if (!get_handle_node(startHandle) || !get_handle_node(endHandle)) {
+		std::cerr << "Shortest path not found: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	if (this->weighted) {
+		return bidirectional_dijkstra(startHandle, endHandle, path, settled);
+	}
+	return bidirectional_breadth_first_search(startHandle, endHandle, path, settled);
+}
+
+
+void Graph::many_to_many(const std::vector<uint32_t>& sourceHandles, const std::vector<uint32_t>& targetHandles,
+	std::vector<double>& distances, std::vector<std::vector<uint32_t>>* paths, size_t threads) {
+
+	// Row i of the matrix is the queries (sources[i], targets[j]), so the cells line up with the
+	// query indices and grouping by source does the rest.
+	std::vector<std::pair<uint32_t, uint32_t>> queries;
+	queries.reserve(sourceHandles.size() * targetHandles.size());
+	for (uint32_t source : sourceHandles) {
+		for (uint32_t target : targetHandles) {
+			queries.emplace_back(source, target);
+		}
+	}
+	shortest_paths(queries, distances, paths, threads);
+}
+
+
+void Graph::many_to_many(const std::vector<std::string>& sourceIds, const std::vector<std::string>& targetIds,
+	std::vector<double>& distances, std::vector<std::vector<std::string>>* paths, size_t threads) {
+
+	std::vector<uint32_t> sourceHandles, targetHandles;
+	for (const std::string& id : sourceIds) {
+		GraphNode* node = get_node(id);
+		if (!node) {
+			std::cerr << "Batch search not run: Node does not exist." << std::endl;
+			throw std::invalid_argument("Node does not exist.");
+		}
+		sourceHandles.push_back(node->handle);
+	}
+	for (const std::string& id : targetIds) {
+		GraphNode* node = get_node(id);
+		if (!node) {
+			std::cerr << "Batch search not run: Node does not exist." << std::endl;
+			throw std::invalid_argument("Node does not exist.");
+		}
+		targetHandles.push_back(node->handle);
+	}
+
+	std::vector<std::vector<uint32_t>> handlePaths;
+	many_to_many(sourceHandles, targetHandles, distances, paths ? &handlePaths : nullptr, threads);
+	if (paths) {
+		paths->assign(handlePaths.size(), std::vector<std::string>());
+		for (size_t i = 0; i < handlePaths.size(); i++) {
+			for (uint32_t handle : handlePaths[i]) {
+				(*paths)[i].push_back(this->handles[handle]->id.to_string());
+			}
+		}
+	}
+}
+
+
+void Graph::shortest_paths(const std::vector<std::pair<uint32_t, uint32_t>>& queries, std::vector<double>& weights,
+	std::vector<std::vector<uint32_t>>* paths, size_t threads) {
+
+	for (const std::pair<uint32_t, uint32_t>& query : queries) {
+		if (!get_handle_node(query.first) || !get_handle_node(query.second)) {
+			std::cerr << "Batch search not run: Node does not exist." << std::endl;
+			throw std::invalid_argument("Node does not exist.");
+		}
+	}
+	weights.assign(queries.size(), INFINITY);
+	if (paths) { paths->assign(queries.size(), std::vector<uint32_t>()); }
+
+	std::vector<size_t> order(queries.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&queries](size_t a, size_t b) {
+		return queries[a].first < queries[b].first;
+	});
+
+	std::vector<uint32_t> starts, entryTargets;
+	std::vector<size_t> offsets, entrySlots;
+	for (size_t i = 0; i < order.size(); i++) {
+		const std::pair<uint32_t, uint32_t>& query = queries[order[i]];
+		if (starts.empty() || starts.back() != query.first) {
+			starts.push_back(query.first);
+			offsets.push_back(entryTargets.size());
+		}
+		entryTargets.push_back(query.second);
+		entrySlots.push_back(order[i]);
+	}
+	offsets.push_back(entryTargets.size());
+	batch_dijkstra(starts, offsets, entryTargets, entrySlots, weights, paths, threads);
+}
+
+
+void Graph::k_shortest_paths(uint32_t startHandle, uint32_t endHandle, size_t k,
+	std::vector<std::vector<uint32_t>>& paths, std::vector<double>& weights, size_t threads) {
+
+	if (!get_handle_node(startHandle) || !get_handle_node(endHandle)) {
+		std::cerr << "K shortest paths not found: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	paths.clear();
+	weights.clear();
+	if (!k) { return; }
+
+	size_t N = this->handles.size();
+	ThreadPool pool(threads);
+	std::vector<SearchScratch> scratch(pool.size, SearchScratch(N));
+	// Root path nodes are masked by stamping them, so each spur search clears its mask for free.
+	std::vector<std::vector<uint32_t>> masked(pool.size, std::vector<uint32_t>(N, 0));
+	std::vector<uint32_t> maskStamp(pool.size, 0);
+
+	// prefixes[p][i] is the weight of paths[p] up to its node i.
+	std::vector<std::vector<double>> prefixes;
+	std::vector<uint32_t> path;
+	std::vector<double> prefix;
+	SearchScratch& first = scratch[0];
+	multi_target_dijkstra(startHandle, &endHandle, 1, first);
+	if (first.distance[endHandle] == INFINITY) {
+		reset_scratch(first);
+		return;
+	}
+	for (uint32_t curr = endHandle; curr != startHandle; curr = first.previous[curr]) {
+		path.push_back(curr);
+	}
+	path.push_back(startHandle);
+	std::reverse(path.begin(), path.end());
+	for (uint32_t node : path) {
+		prefix.push_back(first.distance[node]);
+	}
+	reset_scratch(first);
+	paths.push_back(path);
+	prefixes.push_back(prefix);
+	weights.push_back(prefix.back());
+
+	typedef std::pair<double, size_t> entry;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> candidates;
+	std::vector<std::vector<uint32_t>> candidatePaths;
+	std::vector<std::vector<double>> candidatePrefixes;
+	std::set<std::vector<uint32_t>> seen;
+	seen.insert(path);
+
+	while (paths.size() < k) {
+		const std::vector<uint32_t>& last = paths.back();
+		const std::vector<double>& lastPrefix = prefixes.back();
+		size_t spurs = last.size() - 1;
+		std::vector<std::vector<uint32_t>> spurPaths(spurs);
+		std::vector<std::vector<double>> spurPrefixes(spurs);
+
+		// Each spur node of the last path is searched independently.
+		pool.parallel_for(0, spurs, [&](size_t begin, size_t end, size_t worker) {
+			SearchScratch& local = scratch[worker];
+			std::vector<uint32_t>& mask = masked[worker];
+			std::vector<uint32_t> usedNext;
+			for (size_t i = begin; i < end; i++) {
+				uint32_t spurNode = last[i];
+				if (++maskStamp[worker] == 0) {
+					std::fill(mask.begin(), mask.end(), 0);
+					maskStamp[worker] = 1;
+				}
+				uint32_t stamp = maskStamp[worker];
+				for (size_t j = 0; j < i; j++) {
+					mask[last[j]] = stamp;
+				}
+				// Paths already found that share this root may not leave the spur node the same way.
+				usedNext.clear();
+				for (const std::vector<uint32_t>& found : paths) {
+					if (found.size() > i + 1 && std::equal(found.begin(), found.begin() + i + 1, last.begin())) {
+						usedNext.push_back(found[i + 1]);
+					}
+				}
+
+				multi_target_dijkstra(spurNode, &endHandle, 1, local,
+					[&mask, &usedNext, stamp, spurNode](uint32_t parent, uint32_t child) {
+						if (mask[child] == stamp) { return false; }
+						return parent != spurNode || std::find(usedNext.begin(), usedNext.end(), child) == usedNext.end();
+					});
+				if (local.distance[endHandle] != INFINITY) {
+					std::vector<uint32_t>& spurPath = spurPaths[i];
+					std::vector<double>& spurPrefix = spurPrefixes[i];
+					for (uint32_t curr = endHandle; curr != spurNode; curr = local.previous[curr]) {
+						spurPath.push_back(curr);
+					}
+					spurPath.push_back(spurNode);
+					spurPath.insert(spurPath.end(), last.rend() - i, last.rend());
+					std::reverse(spurPath.begin(), spurPath.end());
+					spurPrefix.assign(lastPrefix.begin(), lastPrefix.begin() + i);
+					for (size_t j = i; j < spurPath.size(); j++) {
+						spurPrefix.push_back(lastPrefix[i] + local.distance[spurPath[j]]);
+					}
+				}
+				reset_scratch(local);
+			}
+		}, 1);
+
+		for (size_t i = 0; i < spurs; i++) {
+			if (spurPaths[i].empty() || !seen.insert(spurPaths[i]).second) { continue; }
+			candidates.push({ spurPrefixes[i].back(), candidatePaths.size() });
+			candidatePaths.push_back(std::move(spurPaths[i]));
+			candidatePrefixes.push_back(std::move(spurPrefixes[i]));
+		}
+		if (candidates.empty()) { break; }
+		size_t next = candidates.top().second;
+		candidates.pop();
+		paths.push_back(std::move(candidatePaths[next]));
+		prefixes.push_back(std::move(candidatePrefixes[next]));
+		weights.push_back(prefixes.back().back());
+	}
+}
+
+
+void Graph::k_shortest_paths(const std::string& startId, const std::string& endId, size_t k,
+	std::vector<std::vector<std::string>>& paths, std::vector<double>& weights, size_t threads) {
+
+	GraphNode* start = get_node(startId), * end = get_node(endId);
+	if (!start || !end) {
+		std::cerr << "K shortest paths not found: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	std::vector<std::vector<uint32_t>> handlePaths;
+	k_shortest_paths(start->handle, end->handle, k, handlePaths, weights, threads);
+	paths.assign(handlePaths.size(), std::vector<std::string>());
+	for (size_t i = 0; i < handlePaths.size(); i++) {
+		for (uint32_t handle : handlePaths[i]) {
+			paths[i].push_back(this->handles[handle]->id.to_string());
+		}
+	}
+}
+
+
+CSRGraph* Graph::to_csr() const {
+
+	size_t N = this->handles.size();
+	std::vector<std::string> csrIds(N);
+	std::vector<uint32_t> offsets(N + 1, 0), reverseOffsets(N + 1, 0);
+
+	for (size_t i = 0; i < N; i++) {
+		csrIds[i] = handles[i]->id.to_string();
+		offsets[i + 1] = offsets[i] + static_cast<uint32_t>(handles[i]->children->size);
+		reverseOffsets[i + 1] = reverseOffsets[i] + static_cast<uint32_t>(handles[i]->parents->size);
+	}
+
+	std::vector<uint32_t> targets(offsets[N]), sources(reverseOffsets[N]);
+	std::vector<double> weights(offsets[N]), reverseWeights(reverseOffsets[N]);
+	for (size_t i = 0; i < N; i++) {
+		uint32_t e = offsets[i];
+		DNode<Neighbor<GraphNode>>* childPtr = handles[i]->children->head;
+		while (childPtr) {
+			targets[e] = childPtr->data->node->handle;
+			weights[e] = this->weighted ? childPtr->data->weight : 1;
+			childPtr = childPtr->next;
+			e++;
+		}
+		e = reverseOffsets[i];
+		DNode<Neighbor<GraphNode>>* parentPtr = handles[i]->parents->head;
+		while (parentPtr) {
+			sources[e] = parentPtr->data->node->handle;
+			reverseWeights[e] = this->weighted ? parentPtr->data->weight : 1;
+			parentPtr = parentPtr->next;
+			e++;
+		}
+	}
+
+	return new CSRGraph(this->graphId, this->weighted, std::move(csrIds),
+		std::move(offsets), std::move(targets), std::move(weights),
+		std::move(reverseOffsets), std::move(sources), std::move(reverseWeights));
+};
+
+
+double Graph::bidirectional_dijkstra(uint32_t startHandle, uint32_t endHandle, std::vector<uint32_t>& path,
+	size_t* settled) {
+
+	size_t N = this->handles.size();
+	std::vector<double> forwardDistance(N, INFINITY), backwardDistance(N, INFINITY);
+	std::vector<uint32_t> previous(N, NULL_HANDLE), next(N, NULL_HANDLE);
+	IndexedHeap<4> forward(N), backward(N);
+
+	forwardDistance[startHandle] = 0;
+	backwardDistance[endHandle] = 0;
+	forward.push(startHandle, 0);
+	backward.push(endHandle, 0);
+	double best = startHandle == endHandle ? 0 : INFINITY;
+	uint32_t meeting = startHandle == endHandle ? startHandle : NULL_HANDLE;
+	size_t expanded = 0;
+
+	while (!forward.is_empty() && !backward.is_empty()) {
+		if (forward.top_key() + backward.top_key() >= best) { break; }
+
+		bool isForward = forward.size() <= backward.size();
+		IndexedHeap<4>& heap = isForward ? forward : backward;
+		std::vector<double>& distance = isForward ? forwardDistance : backwardDistance;
+		std::vector<double>& otherDistance = isForward ? backwardDistance : forwardDistance;
+		std::vector<uint32_t>& link = isForward ? previous : next;
+
+		uint32_t curr = heap.pop();
+		expanded++;
+		DNode<Neighbor<GraphNode>>* ptr = isForward
+			? this->handles[curr]->children->head
+			: this->handles[curr]->parents->head;
+		while (ptr) {
+			uint32_t neighbor = ptr->data->node->handle;
+			double routedWeight = distance[curr] + edge_weight(ptr->data);
+			if (routedWeight < distance[neighbor]) {
+				distance[neighbor] = routedWeight;
+				link[neighbor] = curr;
+				heap.push_or_decrease(neighbor, routedWeight);
+			}
+			if (distance[neighbor] + otherDistance[neighbor] < best) {
+				best = distance[neighbor] + otherDistance[neighbor];
+				meeting = neighbor;
+			}
+			ptr = ptr->next;
+		}
+	}
+	if (settled) { *settled = expanded; }
+
+	path.clear();
+	if (meeting != NULL_HANDLE) {
+		join_bidirectional_path(startHandle, endHandle, meeting, previous, next, path);
+	}
+	return best;
+}
+
+
+double Graph::bidirectional_breadth_first_search(uint32_t startHandle, uint32_t endHandle,
+	std::vector<uint32_t>& path, size_t* settled) {
+
+	size_t N = this->handles.size();
+	std::vector<uint32_t> forwardDistance(N, NULL_HANDLE), backwardDistance(N, NULL_HANDLE);
+	std::vector<uint32_t> previous(N, NULL_HANDLE), next(N, NULL_HANDLE);
+	std::vector<uint32_t> forward{ startHandle }, backward{ endHandle }, level;
+
+	forwardDistance[startHandle] = 0;
+	backwardDistance[endHandle] = 0;
+	uint32_t best = startHandle == endHandle ? 0 : NULL_HANDLE;
+	uint32_t meeting = startHandle == endHandle ? startHandle : NULL_HANDLE;
+	size_t expanded = 0;
+
+	while (meeting == NULL_HANDLE && !forward.empty() && !backward.empty()) {
+
+		bool isForward = forward.size() <= backward.size();
+		std::vector<uint32_t>& frontier = isForward ? forward : backward;
+		std::vector<uint32_t>& distance = isForward ? forwardDistance : backwardDistance;
+		std::vector<uint32_t>& otherDistance = isForward ? backwardDistance : forwardDistance;
+		std::vector<uint32_t>& link = isForward ? previous : next;
+
+		// Finish the whole level before stopping, so the shortest of its meetings wins.
+		level.clear();
+		for (uint32_t curr : frontier) {
+			expanded++;
+			DNode<Neighbor<GraphNode>>* ptr = isForward
+				? this->handles[curr]->children->head
+				: this->handles[curr]->parents->head;
+			while (ptr) {
+				uint32_t neighbor = ptr->data->node->handle;
+				if (distance[neighbor] == NULL_HANDLE) {
+					distance[neighbor] = distance[curr] + 1;
+					link[neighbor] = curr;
+					level.push_back(neighbor);
+					if (otherDistance[neighbor] != NULL_HANDLE
+						&& distance[neighbor] + otherDistance[neighbor] < best) {
+						best = distance[neighbor] + otherDistance[neighbor];
+						meeting = neighbor;
+					}
+				}
+				ptr = ptr->next;
+			}
+		}
+		frontier.swap(level);
+	}
+	if (settled) { *settled = expanded; }
+
+	path.clear();
+	if (meeting == NULL_HANDLE) {
+		return INFINITY;
+	}
+	join_bidirectional_path(startHandle, endHandle, meeting, previous, next, path);
+	return best;
+}
+
+
+void Graph::join_bidirectional_path(uint32_t startHandle, uint32_t endHandle, uint32_t meeting,
+	std::vector<uint32_t>& previous, std::vector<uint32_t>& next, std::vector<uint32_t>& path) {
+
+	uint32_t curr = meeting;
+	while (curr != startHandle) {
+		path.push_back(curr);
+		curr = previous[curr];
+	}
+	path.push_back(startHandle);
+	std::reverse(path.begin(), path.end());
+
+	curr = meeting;
+	while (curr != endHandle) {
+		curr = next[curr];
+		path.push_back(curr);
+	}
+}
+
+
+void Graph::batch_dijkstra(const std::vector<uint32_t>& starts, const std::vector<size_t>& offsets,
+	const std::vector<uint32_t>& entryTargets, const std::vector<size_t>& entrySlots,
+	std::vector<double>& weights, std::vector<std::vector<uint32_t>>* paths, size_t threads) {
+
+	if (starts.empty()) { return; }
+	ThreadPool pool(threads);
+	std::vector<SearchScratch> scratch(pool.size, SearchScratch(this->handles.size()));
+
+	// Every group is a whole search, so they are handed out one at a time.
+	pool.parallel_for(0, starts.size(), [&](size_t begin, size_t end, size_t worker) {
+		SearchScratch& local = scratch[worker];
+		for (size_t g = begin; g < end; g++) {
+			multi_target_dijkstra(starts[g], &entryTargets[offsets[g]], offsets[g + 1] - offsets[g], local);
+			for (size_t e = offsets[g]; e < offsets[g + 1]; e++) {
+				uint32_t target = entryTargets[e];
+				weights[entrySlots[e]] = local.distance[target];
+				if (!paths || local.previous[target] == NULL_HANDLE) { continue; }
+
+				std::vector<uint32_t>& path = (*paths)[entrySlots[e]];
+				for (uint32_t curr = target; curr != starts[g]; curr = local.previous[curr]) {
+					path.push_back(curr);
+				}
+				path.push_back(starts[g]);
+				std::reverse(path.begin(), path.end());
+			}
+			reset_scratch(local);
+		}
+	}, 1);
+}
+
+
+void Graph::reset_scratch(SearchScratch& scratch) {
+	for (uint32_t handle : scratch.touched) {
+		scratch.distance[handle] = INFINITY;
+		scratch.previous[handle] = NULL_HANDLE;
+	}
+	scratch.touched.clear();
+	scratch.remaining.clear();
+}
+
+
 void Graph::validate_weight(bool weight) {
 
 	if (weight && !this->weighted) {
@@ -619,12 +1885,44 @@ GraphNode* Graph::get_node(const std::string& id) const { return this->nodes->ge
 GraphNode* Graph::get_node(String& id) const { return this->nodes->get(id.to_string()); };
 
 
+GraphNode* Graph::get_handle_node(uint32_t handle) const {
+	if (handle >= this->handles.size()) {
+		return nullptr;
+	}
+	return this->handles[handle];
+};
+
+
+void Graph::register_node(GraphNode* node) {
+	node->handle = static_cast<uint32_t>(this->handles.size());
+	this->handles.push_back(node);
+	for (GraphListener* listener : this->listeners) {
+		listener->on_node_added(node->handle);
+	}
+};
+
+
+void Graph::unregister_node(GraphNode* node) {
+	uint32_t handle = node->handle;
+	GraphNode* last = this->handles.back();
+	uint32_t movedFrom = last->handle;
+	this->handles[handle] = last;
+	last->handle = handle;
+	this->handles.pop_back();
+	node->handle = NULL_HANDLE;
+	for (GraphListener* listener : this->listeners) {
+		listener->on_node_removed(handle, movedFrom);
+	}
+};
+
+
 void Graph::create_node(const std::string& id, const bool weighted) {
 	this->count++;
 	String* nodeId = new String(id);
 	GraphNode* newGraphNode = new GraphNode(*nodeId, weighted);
 	this->ids->append(*nodeId);
 	this->nodes->put(id, *newGraphNode);
+	this->register_node(newGraphNode);
 };
 
 
@@ -634,10 +1932,58 @@ Neighbor<GraphNode>* Graph::create_neighbor(GraphNode* node, double weight) {
 };
 
 
+void Graph::connect_nodes(GraphNode* parentNode, GraphNode* childNode, double parent_to_child_weight) {
+
+	bool added = !parentNode->children->contains_id(childNode->id);
+	if (added) {
+		for (GraphListener* listener : this->listeners) {
+			listener->before_edge_added(parentNode->handle, childNode->handle);
+		}
+	}
+	Neighbor<GraphNode>* parentNeighbor = create_neighbor(childNode, parent_to_child_weight);
+	Neighbor<GraphNode>* childNeighbor = create_neighbor(parentNode, parent_to_child_weight);
+
+	if (added) {
+		parentNode->children->append(*parentNeighbor);
+	}
+	if (!childNode->parents->contains_id(*childNeighbor->id)) {
+		childNode->parents->append(*childNeighbor);
+	}
+	if (added) {
+		for (GraphListener* listener : this->listeners) {
+			listener->on_edge_added(parentNode->handle, childNode->handle, edge_weight(parentNeighbor));
+		}
+	}
+};
+
+
+void Graph::disconnect_nodes(GraphNode* parent, GraphNode* child) {
+
+	DNode<Neighbor<GraphNode>>* edge = parent->children->head;
+	while (edge && edge->data->node != child) {
+		edge = edge->next;
+	}
+	bool existed = edge != nullptr;
+	double weight = existed ? edge_weight(edge->data) : 0;
+
+	parent->children->remove_id(child->id);
+	child->parents->remove_id(parent->id);
+	if (existed) {
+		for (GraphListener* listener : this->listeners) {
+			listener->on_edge_removed(parent->handle, child->handle, weight);
+		}
+	}
+};
+
+
 void Graph::remove_edge(String& parentId, String& childId) {
 	GraphNode* child = this->get_node(childId);
 	GraphNode* parent = this->get_node(parentId);
 
+	if (parent && child) {
+		disconnect_nodes(parent, child);
+		return;
+	}
 	if (parent) {
 		SmartList<Neighbor<GraphNode>>* parentChildren = parent->children;
 		parentChildren->remove_id(childId);
@@ -673,6 +2019,7 @@ void Graph::remove_node(String& nodeId) {
 
 	this->ids->remove_val(nodeId.to_string());
 	this->nodes->remove(nodeId.to_string());
+	this->unregister_node(node);
 	this->count--;
 	delete(node);
 };
@@ -691,50 +2038,22 @@ void Graph::swap_nodes(String& id1, String& id2) {
 };
 
 
-bool Graph::depth_traverse_memo_stopcall(
-	String& id,
-	callType					func,
-	SmartList<String>* memo,
-	int* rcarg,
-	std::string					title
-) {
-
-	bool STOP_FLAG = false;
-	if (memo->contains_ref(&id)) {
-		STOP_FLAG = true;
-	}
-	else {
-		STOP_FLAG = func(id.to_string());
-		memo->append(id);
-	}
-	return STOP_FLAG;
-};
-
-
-void Graph::depth_first_search(
-	const std::string&			startId,
-	SmartList<String>*	memo,
-	callType					func) {
-
-	typedef decltype(Graph::depth_traverse_memo_stopcall)* memoStopCallType;
-	memoStopCallType memoStopCallPtr = &Graph::depth_traverse_memo_stopcall;
+void Graph::depth_first_search(const std::string& startId, SmartList<String>* memo, callType func) {
 
+	GraphNode* start = get_node(startId);
 	callType funcPtr = func ? func : doNothing;
-
-	int* ptr = new int(0);
-
-	depth_traverse<memoStopCallType, callType, SmartList<String>*,
-		int*, std::string>(
-
-			get_node(startId)->id,
-			memoStopCallPtr,
-			funcPtr,
-			memo,
-			ptr,
-			graphId
-
-			);
-	return;
+	DepthFirstState state;
+	state.begin(this->handles.size());
+	for (DNode<String>* ptr = memo->head; ptr; ptr = ptr->next) {
+		state.exclude(get_node(*ptr->data)->handle);
+	}
+	depth_first_traversal(start->handle, state,
+		[this, memo, funcPtr](uint32_t handle) {
+			bool prune = funcPtr(this->handles[handle]->id.to_string());
+			memo->append(this->handles[handle]->id);
+			return prune;
+		},
+		NoVisit(), NoVisit());
 };
 
 
@@ -751,150 +2070,214 @@ void Graph::breadth_first_search(const std::string& startId, SmartList<String>*
 }
 
 
-bool Graph::topological_sort_helper(String& currId, SmartList<String>* path,
-	SmartList<String>* seen, Stack<String>* sorted) {
+size_t Graph::top_down_step(ThreadPool& pool, std::vector<uint32_t>& frontier, std::vector<uint32_t>& next,
+	AtomicBitmap& visited, std::vector<uint32_t>& parent, std::vector<uint32_t>& distance, uint32_t level) {
+
+	std::vector<std::vector<uint32_t>> found(pool.size);
+	std::vector<size_t> foundEdges(pool.size, 0);
+
+	pool.parallel_for(0, frontier.size(), [&](size_t begin, size_t end, size_t worker) {
+		for (size_t i = begin; i < end; i++) {
+			DNode<Neighbor<GraphNode>>* childPtr = this->handles[frontier[i]]->children->head;
+			while (childPtr) {
+				GraphNode* child = childPtr->data->node;
+				// Only the thread that claims the bit writes the child's slots.
+				if (!visited.test(child->handle) && visited.set(child->handle)) {
+					parent[child->handle] = frontier[i];
+					distance[child->handle] = level + 1;
+					found[worker].push_back(child->handle);
+					foundEdges[worker] += child->children->size;
+				}
+				childPtr = childPtr->next;
+			}
+		}
+	});
+
+	size_t nextEdges = 0;
+	for (size_t w = 0; w < pool.size; w++) {
+		next.insert(next.end(), found[w].begin(), found[w].end());
+		nextEdges += foundEdges[w];
+	}
+	return nextEdges;
+}
 
-	seen->append(currId);
-	path->append(currId);
 
-	DNode<Neighbor<GraphNode>>* childPtr = get_node(currId)->children->head;
-	while (childPtr) {
-		if (path->contains_val(childPtr->data->id->to_string())) { return false; }
+size_t Graph::bottom_up_step(ThreadPool& pool, std::vector<uint32_t>& frontier, std::vector<uint32_t>& next,
+	AtomicBitmap& visited, std::vector<uint32_t>& parent, std::vector<uint32_t>& distance, uint32_t level) {
 
-		if (!seen->contains_val(childPtr->data->id->to_string())) {
-			bool success = topological_sort_helper(*childPtr->data->id, path->copy(), seen, sorted);
-			if (!success) { return false; }
+	AtomicBitmap inFrontier(this->handles.size());
+	pool.parallel_for(0, frontier.size(), [&](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; i++) {
+			inFrontier.set(frontier[i]);
 		}
-		childPtr = childPtr->next;
-	}
+	});
+
+	std::vector<std::vector<uint32_t>> found(pool.size);
+	std::vector<size_t> foundEdges(pool.size, 0);
+
+	pool.parallel_for(0, this->handles.size(), [&](size_t begin, size_t end, size_t worker) {
+		for (size_t v = begin; v < end; v++) {
+			if (visited.test(v)) { continue; }
+			DNode<Neighbor<GraphNode>>* parentPtr = this->handles[v]->parents->head;
+			while (parentPtr) {
+				uint32_t p = parentPtr->data->node->handle;
+				if (inFrontier.test(p)) {
+					visited.set(v);
+					parent[v] = p;
+					distance[v] = level + 1;
+					found[worker].push_back(static_cast<uint32_t>(v));
+					foundEdges[worker] += this->handles[v]->children->size;
+					break;
+				}
+				parentPtr = parentPtr->next;
+			}
+		}
+	});
 
-	sorted->push(currId);
-	return true;
+	size_t nextEdges = 0;
+	for (size_t w = 0; w < pool.size; w++) {
+		next.insert(next.end(), found[w].begin(), found[w].end());
+		nextEdges += foundEdges[w];
+	}
+	return nextEdges;
 }
 
 
-// If possible, returns a topologically-sorted list of the nodes; where each node supercedes 
-// all of its parents. 
-void Graph::topological_sort(SmartList<String>* memo) {
+void Graph::multi_source_batch(const std::vector<uint32_t>& startHandles, size_t first, size_t batchSize,
+	std::vector<std::vector<uint32_t>>& distances) {
 
-	Stack<String>* sorted = new Stack<String>();
-	SmartList<String>* seen = new SmartList<String>();
-	SmartList<String>* path = new SmartList<String>();
-	SmartList<String>* keys = nodes->keys();
+	size_t N = this->handles.size();
+	size_t W = (batchSize + 63) / 64;
+
+	// Row h of each array holds W words, with bit i standing for search first + i.
+	std::vector<uint64_t> seen(N * W, 0), visit(N * W, 0), visitNext(N * W, 0);
+	for (size_t i = 0; i < batchSize; i++) {
+		uint32_t start = startHandles[first + i];
+		uint64_t bit = uint64_t(1) << (i & 63);
+		seen[start * W + (i >> 6)] |= bit;
+		visit[start * W + (i >> 6)] |= bit;
+		distances[first + i][start] = 0;
+	}
 
-	DNode<String>* idPtr = keys->head;
-	while (idPtr) {
-		if (!seen->contains_val(idPtr->data->to_string())) {
+	bool active = true;
+	for (uint32_t level = 1; active; level++) {
 
-			bool success = topological_sort_helper(*idPtr->data, path->copy(), seen, sorted);
-			if (!success) { return; }
+		for (size_t v = 0; v < N; v++) {
+			bool any = false;
+			for (size_t w = 0; w < W; w++) {
+				if (visit[v * W + w]) { any = true; break; }
+			}
+			if (!any) { continue; }
+
+			DNode<Neighbor<GraphNode>>* childPtr = this->handles[v]->children->head;
+			while (childPtr) {
+				size_t child = childPtr->data->node->handle;
+				for (size_t w = 0; w < W; w++) {
+					visitNext[child * W + w] |= visit[v * W + w];
+				}
+				childPtr = childPtr->next;
+			}
 		}
-		idPtr = idPtr->next;
+
+		active = false;
+		for (size_t v = 0; v < N; v++) {
+			for (size_t w = 0; w < W; w++) {
+				uint64_t reached = visitNext[v * W + w] & ~seen[v * W + w];
+				visitNext[v * W + w] = reached;
+				if (!reached) { continue; }
+				active = true;
+				seen[v * W + w] |= reached;
+				while (reached) {
+					size_t i = w * 64 + std::countr_zero(reached);
+					distances[first + i][v] = level;
+					reached &= reached - 1;
+				}
+			}
+		}
+		visit.swap(visitNext);
+		std::fill(visitNext.begin(), visitNext.end(), 0);
 	}
-	while (sorted->top) {
-		String* temp = sorted->pop();
-		memo->append(*temp);
+}
+
+
+// If possible, returns a topologically-sorted list of the nodes; where each node supercedes 
+// all of its parents. 
+void Graph::topological_sort(SmartList<String>* memo) {
+
+	std::vector<uint32_t> order, levelOffsets;
+	if (!topological_levels(order, levelOffsets, nullptr, 1)) { return; }
+	for (uint32_t handle : order) {
+		memo->append(this->handles[handle]->id);
 	}
 }
 
 
 void Graph::post_order_depth_first_search(String& startId, SmartList<String>* memo,
 	SmartList<String>* seen) {
-	if (!seen->contains_val(startId.to_string())) {
-		seen->append(startId);
-		SmartList<Neighbor<GraphNode>>* children = get_node(startId)->children;
-		DNode<Neighbor<GraphNode>>* ptr = children->head;
-		while (ptr) {
-			post_order_depth_first_search(ptr->data->node->id, memo, seen);
-			ptr = ptr->next;
-		}
-		memo->append(startId);
-	}
+
+	DepthFirstState state;
+	state.begin(this->handles.size());
+	for (DNode<String>* ptr = seen->head; ptr; ptr = ptr->next) {
+		state.exclude(get_node(*ptr->data)->handle);
+	}
+	depth_first_traversal(get_node(startId)->handle, state,
+		[this, seen](uint32_t handle) {
+			seen->append(this->handles[handle]->id);
+			return false;
+		},
+		[this, memo](uint32_t handle) { memo->append(this->handles[handle]->id); },
+		NoVisit());
 }
 
 
-void Graph::forest_post_order_depth_first_search(
-	SmartList<SmartList<String>>* memo) {
+void Graph::forest_post_order_depth_first_search(SmartList<SmartList<String>>* memo) {
 
-	SmartList<String>* ids = nodes->keys();
-	SmartList<String>* seen = new SmartList<String>;
-	while (!ids->is_empty()) {
+	std::vector<uint32_t> roots;
+	forest_roots(roots);
+	DepthFirstState state;
+	state.begin(this->handles.size());
+	for (uint32_t root : roots) {
+		if (state.discovered[root] == state.epoch) { continue; }
 		SmartList<String>* postDFSmemo = new SmartList<String>;
-		SmartList<String>* currMemo = new SmartList<String>;
-
-		String start = *ids->head->data;
-		SmartList<String>* path = new SmartList<String>;
-		String* furthestParentMemo = new String("");
-		find_furthest_parent(start, path, 0, furthestParentMemo);
-		post_order_depth_first_search(*furthestParentMemo, postDFSmemo, seen);
-
+		depth_first_traversal(root, state,
+			NoVisit(),
+			[this, postDFSmemo](uint32_t handle) { postDFSmemo->append(this->handles[handle]->id); },
+			NoVisit());
 		memo->append(*postDFSmemo);
-		ids->difference(postDFSmemo);
 	}
-
 };
 
 
-int Graph::find_furthest_parent(String& id, SmartList<String>* path,
-	int currDistance, String* memo) {
-
-	GraphNode* node = get_node(id);
-	SmartList<Neighbor<GraphNode>>* parents = node->parents;
-	if (parents->is_empty() || path->contains_val(id.to_string())) {
-		*memo = id;
-		return currDistance;
+void Graph::forest_roots(std::vector<uint32_t>& roots) const {
+	roots.clear();
+	roots.reserve(this->handles.size() * 2);
+	for (uint32_t v = 0; v < this->handles.size(); v++) {
+		if (this->handles[v]->parents->is_empty()) { roots.push_back(v); }
 	}
-	path->append(id);
-	DNode<Neighbor<GraphNode>>* ptr = parents->head;
-	int maxDistance = currDistance;
-	String furthestParent{ "" };
-
-	while (ptr) {
-		if (!path->contains_val(ptr->data->node->id.to_string())) {
-			SmartList<String>* newPath = path->copy();
-			String* currNode = new String(ptr->data->node->id.to_string());
-			int newDistance = find_furthest_parent(*currNode, newPath, currDistance + 1, memo);
-			if (newDistance > maxDistance) {
-				maxDistance = newDistance;
-				furthestParent = *memo;
-			}
-			delete(currNode);
-			delete(newPath);
-		}
-		ptr = ptr->next;
+	for (uint32_t v = 0; v < this->handles.size(); v++) {
+		roots.push_back(v);
 	}
-
-	if (furthestParent.to_string() != "") {
-		*memo = furthestParent;
-	}
-	else {
-		*memo = id;
-	}
-	return maxDistance;
 };
 
 
- void Graph::forest_depth_first_search(SmartList<SmartList<String>>* memo,
-	callType func) {
+void Graph::forest_depth_first_search(SmartList<SmartList<String>>* memo, callType func) {
 
-	SmartList<String>* ids = nodes->keys();
-	SmartList<String>* DFSmemo = new SmartList<String>;
-	while (!ids->is_empty()) {
+	callType funcPtr = func ? func : doNothing;
+	std::vector<uint32_t> roots;
+	forest_roots(roots);
+	DepthFirstState state;
+	state.begin(this->handles.size());
+	for (uint32_t root : roots) {
+		if (state.discovered[root] == state.epoch) { continue; }
 		SmartList<String>* currMemo = new SmartList<String>;
-		DNode<String>* lastSeen = DFSmemo->tail;
-		String start = *ids->head->data;
-		SmartList<String>* path = new SmartList<String>;
-		String* furthestParentMemo = new String("");
-		find_furthest_parent(start, path, 0, furthestParentMemo);
-		depth_first_search(furthestParentMemo->to_string(), DFSmemo, func);
-
-		DNode<String>* ptr = lastSeen ? lastSeen->next : DFSmemo->head;
-		while (ptr) {
-			currMemo->append(*ptr->data);
-			ptr = ptr->next;
-		}
+		depth_first_traversal(root, state,
+			[this, currMemo, funcPtr](uint32_t handle) {
+				bool prune = funcPtr(this->handles[handle]->id.to_string());
+				currMemo->append(this->handles[handle]->id);
+				return prune;
+			},
+			NoVisit(), NoVisit());
 		memo->append(*currMemo);
-		ids->difference(DFSmemo);
 	}
 }
 
@@ -982,43 +2365,17 @@ void Graph::kosaraju_search(
 void Graph::dijsktras_algorithm(const std::string& startId, 
 	HashTable<String>& previous) {
 
-	HashTable<double> pathToNodeWeight{};
-	BinaryHeap remaining{};
-	remaining.initialize();
+	std::vector<double> distance;
+	std::vector<uint32_t> previousHandles;
+	this->dijsktras_algorithm(get_node(startId)->handle, distance, previousHandles);
 
-	remaining.insert(startId, 0);
-	pathToNodeWeight.put(startId, *(new double(0)));
-	previous.put(startId, *(new String(startId)));
-
-	SmartList<String>* keys = this->nodes->keys();
-	DNode<String>* ptr = keys->head;
-	while (ptr) {
-		if (ptr->data->to_string() != startId) {
-			remaining.insert(ptr->data->to_string(), INFINITY);
-			pathToNodeWeight.put(ptr->data->to_string(), *(new double(INFINITY)));
-			previous.put(ptr->data->to_string(), *(new String("")));
+	String* unreached = new String("");
+	for (size_t i = 0; i < this->handles.size(); i++) {
+		if (previousHandles[i] == NULL_HANDLE) {
+			previous.put(this->handles[i]->id.to_string(), *unreached);
 		}
-		ptr = ptr->next;
-	}
-	while (remaining.count > 0) {
-		std::pair<String, Double>* curr = remaining.pop();
-		String* currId = new String(std::get<0>(*curr).to_string());
-		Double currWeight = std::get<1>(*curr);
-
-		DNode<Neighbor<GraphNode>>* child = get_node(*currId)->children->head;
-		while (child) {
-			String* childId = &child->data->node->id;
-			double currToChildWeight = child->data->weight;
-
-			double* routedWeight = new double(currWeight.value + currToChildWeight);
-			double directWeight = *pathToNodeWeight.get(childId->to_string());
-
-			if (*routedWeight < directWeight) {
-				pathToNodeWeight.put(childId->to_string(), *routedWeight);
-				remaining.update_node(childId->to_string(), *routedWeight);
-				previous.put(childId->to_string(), *currId);
-			}
-			child = child->next;
+		else {
+			previous.put(this->handles[i]->id.to_string(), this->handles[previousHandles[i]]->id);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "graph_node.h"
+#include "csr_graph.h"
 #include <string>
 #include <sstream>
 #include "../nodes.h"
@@ -7,14 +8,59 @@
 #include "../queue.h"
 #include "../stack.h"
 #include "../wrappers.h"
+#include "../bitmap.h"
+#include "../thread_pool.h"
+#include "../indexed_heap.h"
+#include "../generator.h"
 
 #include <iterator>
 #include <stdexcept>
 #include <vector>
 #include <map>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
 
 typedef std::tuple<std::string, std::string, double> weighted_edge;
 
+
+/* Observer of structural changes to a Graph, for structures derived from it that want to repair
+themselves instead of being rebuilt. Edge notifications arrive after the change, carrying the
+edge weight (1 on unweighted graphs); an edge that already existed is not reported again. When
+a node is removed its edges are reported removed first, then on_node_removed says that the node
+at handle is gone and that the node previously at movedFrom now lives at handle (movedFrom ==
+handle when the removed node was the last one). before_edge_added runs before a new edge is
+linked in, so a listener that cannot accept the edge may throw and leave the graph unchanged. */
+class GraphListener {
+
+public:
+
+	virtual ~GraphListener() {}
+
+
+	virtual void on_node_added(uint32_t) {}
+
+
+	virtual void on_node_removed(uint32_t, uint32_t) {}
+
+
+	virtual void before_edge_added(uint32_t, uint32_t) {}
+
+
+	virtual void on_edge_added(uint32_t, uint32_t, double) {}
+
+
+	virtual void on_edge_removed(uint32_t, uint32_t, double) {}
+};
+
+/* Whether Visitor can be passed to the templated traversals: a callable taking either a node
+handle or a const GraphNode&. Returning true has the same meaning as returning true from a
+callType; returning nothing never stops or prunes anything. */
+template<typename Visitor>
+inline constexpr bool is_graph_visitor = std::is_invocable_v<Visitor&, uint32_t>
+	|| std::is_invocable_v<Visitor&, const GraphNode&>;
+
+
 class Graph {
 
 protected:
@@ -26,6 +72,8 @@ protected:
 	size_t count;
 	bool hasInitialized = false;
 	HashTable<GraphNode>* nodes;
+	std::vector<GraphNode*> handles;
+	std::vector<GraphListener*> listeners;
 	
 	void set_type(const std::string& type) {
 		this->type = type;
@@ -56,10 +104,162 @@ public:
 	bool exists_node(const std::string& id) const;
 
 
+	/* Every node is given a dense handle in [0, count) when it is created. Handles are stable
+	until a node is removed, at which point the last node takes over the removed node's handle. */
+	uint32_t get_handle(const std::string& id) const;
+
+
+	std::string get_id(uint32_t handle) const;
+
+
+	size_t handle_count() const;
+
+
+	/* Calls func(neighborHandle, weight) for every child of handle, or every parent with parents
+	set. Unweighted edges report a weight of 1. */
+	template<typename F>
+	void for_each_neighbor(uint32_t handle, F func, bool parents = false) const {
+		GraphNode* node = get_handle_node(handle);
+		if (!node) {
+			std::cerr << "Node does not exist." << std::endl;
+			throw std::invalid_argument("Node does not exist.");
+		}
+		DNode<Neighbor<GraphNode>>* neighbor = parents ? node->parents->head : node->children->head;
+		while (neighbor) {
+			func(neighbor->data->node->handle, edge_weight(neighbor->data));
+			neighbor = neighbor->next;
+		}
+	}
+
+
+	enum EdgeType {
+		TREE_EDGE,
+		// Leads to a node still on the search stack, so it closes a cycle.
+		BACK_EDGE,
+		// Leads to a finished descendant.
+		FORWARD_EDGE,
+		// Leads to a finished node that is not a descendant, possibly from an earlier search.
+		CROSS_EDGE
+	};
+
+
+	/* Scratch for depth_first_traversal. Each search owns one, and the searches of a forest share
+	one so later trees skip what earlier ones reached. A node counts as discovered when
+	discovered[handle] == epoch and as finished when finished[handle] does too, so starting a
+	fresh search with the same state only bumps epoch. */
+	struct DepthFirstState {
+		uint32_t epoch = 0;
+		uint32_t counter = 0;
+		std::vector<uint32_t> discovered;
+		std::vector<uint32_t> finished;
+		std::vector<uint32_t> preorder;
+		std::vector<std::pair<uint32_t, DNode<Neighbor<GraphNode>>*>> stack;
+
+		void begin(size_t nodeCount) {
+			if (discovered.size() < nodeCount) {
+				discovered.resize(nodeCount, 0);
+				finished.resize(nodeCount, 0);
+				preorder.resize(nodeCount, 0);
+			}
+			if (++epoch == 0) {
+				std::fill(discovered.begin(), discovered.end(), 0);
+				std::fill(finished.begin(), finished.end(), 0);
+				epoch = 1;
+			}
+			counter = 0;
+			stack.reserve(nodeCount);
+		}
+
+
+		// Marks handle as already searched, for nodes covered by an earlier traversal.
+		void exclude(uint32_t handle) {
+			discovered[handle] = epoch;
+			finished[handle] = epoch;
+		}
+	};
+
+
+	/* Stands in for any depth_first_traversal callback a caller doesn't need: as preVisit it
+	never prunes, and as postVisit or edgeVisit it does nothing. */
+	struct NoVisit {
+		template<typename... Args>
+		bool operator()(Args&&...) const { return false; }
+	};
+
+
+	/* Iterative depth first search from startHandle over an explicit stack of child iterators,
+	visiting children in list order. preVisit(handle) runs when a node is discovered and returns
+	true to leave its children unexplored; postVisit(handle) runs once its children are done; and
+	edgeVisit(parent, child, EdgeType) runs for every edge examined. Nodes discovered since
+	state.begin are skipped, so a forest is several calls sharing one begin. */
+	template<typename PreVisit, typename PostVisit, typename EdgeVisit>
+	void depth_first_traversal(uint32_t startHandle, DepthFirstState& state, PreVisit preVisit,
+		PostVisit postVisit, EdgeVisit edgeVisit) const {
+
+		if (state.discovered[startHandle] == state.epoch) { return; }
+		auto discover = [this, &state, &preVisit](uint32_t handle) {
+			state.discovered[handle] = state.epoch;
+			state.preorder[handle] = state.counter++;
+			bool prune = preVisit(handle);
+			state.stack.emplace_back(handle, prune ? nullptr : this->handles[handle]->children->head);
+		};
+
+		discover(startHandle);
+		while (!state.stack.empty()) {
+			uint32_t curr = state.stack.back().first;
+			DNode<Neighbor<GraphNode>>* childPtr = state.stack.back().second;
+			if (!childPtr) {
+				state.finished[curr] = state.epoch;
+				state.stack.pop_back();
+				postVisit(curr);
+				continue;
+			}
+			state.stack.back().second = childPtr->next;
+
+			uint32_t child = childPtr->data->node->handle;
+			if (state.discovered[child] != state.epoch) {
+				edgeVisit(curr, child, TREE_EDGE);
+				discover(child);
+			}
+			else if (state.finished[child] != state.epoch) {
+				edgeVisit(curr, child, BACK_EDGE);
+			}
+			else {
+				edgeVisit(curr, child, state.preorder[child] > state.preorder[curr] ? FORWARD_EDGE : CROSS_EDGE);
+			}
+		}
+	}
+
+
+	/* depth_first_traversal as a single search with scratch state of its own. Nothing is shared
+	between calls, so a callback may start another search on the same graph, and searches on a
+	graph nobody is changing may run on several threads at once. */
+	template<typename PreVisit, typename PostVisit, typename EdgeVisit>
+	void depth_first_traversal(uint32_t startHandle, PreVisit preVisit, PostVisit postVisit, EdgeVisit edgeVisit) const {
+		if (!get_handle_node(startHandle)) {
+			std::cerr << "Start node does not exist." << std::endl;
+			throw std::invalid_argument("Start node does not exist.");
+		}
+		DepthFirstState state;
+		state.begin(this->handles.size());
+		depth_first_traversal(startHandle, state, preVisit, postVisit, edgeVisit);
+	}
+
+
+	// Listeners are not owned; remove one before destroying it.
+	void add_listener(GraphListener* listener);
+
+
+	void remove_listener(GraphListener* listener);
+
+
 	void check_make_edge(const std::string& parent, const std::string& child, double parent_to_child_weight = -1);
 
 
 	void make_edge(const std::string& parent, const std::string& child, double parent_to_child_weight = -1);
+
+
+	void make_edge(uint32_t parent, uint32_t child, double parent_to_child_weight = -1);
 	
 
 	void insert(const std::string& node, std::string(&parents)[], std::string(&children)[]);
@@ -87,6 +287,9 @@ public:
 
 
 	virtual void remove_edge(const std::string& parentId, const std::string& childId);
+
+
+	virtual void remove_edge(uint32_t parentHandle, uint32_t childHandle);
 	
 
 	virtual void remove_node(const std::string& nodeId);
@@ -124,6 +327,24 @@ public:
 
 	void depth_first_search(const std::string& startId, std::vector<std::string>& memo, callType func = nullptr);
 
+
+	/* Handle-based depth first search; the visited set is indexed by handle instead of searched. */
+	void depth_first_search(uint32_t startHandle, std::vector<uint32_t>& memo, callType func = nullptr);
+
+
+	/* depth_first_search with any visitor in place of a callType, so the per-node call can be
+	inlined and carry state. */
+	template<typename Visitor, std::enable_if_t<is_graph_visitor<Visitor>, int> = 0>
+	void depth_first_search(uint32_t startHandle, std::vector<uint32_t>& memo, Visitor visitor) {
+		// A node whose visitor returns true is still recorded, but its children are not explored.
+		depth_first_traversal(startHandle,
+			[this, &memo, &visitor](uint32_t handle) {
+				memo.push_back(handle);
+				return visit(visitor, handle);
+			},
+			NoVisit(), NoVisit());
+	}
+
 	template <size_t N>
 	void breadth_first_search(std::vector<std::string> &startIds,
 		std::vector<std::vector<std::string>>& memo, callType func = nullptr) {
@@ -202,6 +423,60 @@ public:
 	void breadth_first_search(const std::string& startId, std::vector<std::string>& memo, callType func = nullptr);
 
 
+	/* Handle-based breadth first search; memo doubles as the queue. */
+	void breadth_first_search(uint32_t startHandle, std::vector<uint32_t>& memo, callType func = nullptr);
+
+
+	template<typename Visitor, std::enable_if_t<is_graph_visitor<Visitor>, int> = 0>
+	void breadth_first_search(uint32_t startHandle, std::vector<uint32_t>& memo, Visitor visitor) {
+
+		if (!get_handle_node(startHandle)) {
+			std::cerr << "Start node does not exist." << std::endl;
+			throw std::invalid_argument("Start node does not exist.");
+		}
+		std::vector<bool> seen(handles.size(), false);
+
+		// A node whose visitor returns true ends the search before it is recorded.
+		if (visit(visitor, startHandle)) { return; }
+		size_t head = memo.size();
+		seen[startHandle] = true;
+		memo.push_back(startHandle);
+
+		while (head < memo.size()) {
+			DNode<Neighbor<GraphNode>>* childPtr = handles[memo[head]]->children->head;
+			head++;
+			while (childPtr) {
+				uint32_t child = childPtr->data->node->handle;
+				if (!seen[child]) {
+					if (visit(visitor, child)) { return; }
+					seen[child] = true;
+					memo.push_back(child);
+				}
+				childPtr = childPtr->next;
+			}
+		}
+	}
+
+
+	/* Level-synchronous breadth first search spread over a pool of threads (zero means one per
+	core). Each level is expanded top-down from the frontier, or bottom-up by scanning the parents
+	of unvisited nodes once the frontier touches a large share of the remaining edges. Fills parent
+	and distance by handle; unreached nodes are left at NULL_HANDLE. */
+	void parallel_breadth_first_search(uint32_t startHandle, std::vector<uint32_t>& parent,
+		std::vector<uint32_t>& distance, size_t threads = 0);
+
+
+	/* Runs one breadth first search per start, any number of starts, in batches of up to 256 that
+	share each adjacency scan: every node keeps one bit per search in the batch (MS-BFS).
+	distances[i][h] is the hop count from startHandles[i] to h, or NULL_HANDLE if unreached. */
+	void multi_source_breadth_first_search(const std::vector<uint32_t>& startHandles,
+		std::vector<std::vector<uint32_t>>& distances);
+
+
+	void multi_source_breadth_first_search(const std::vector<std::string>& startIds,
+		std::vector<std::vector<uint32_t>>& distances);
+
+
 	template<size_t N>
 	void breadth_first_search(const std::string& startId, std::string (&memo)[N],
 		callType func = nullptr) {
@@ -240,20 +515,11 @@ public:
 		SmartList<String>* memoList[N]{};
 		for (size_t i = 0; i < N; i++) {
 			ids[i] = *(startIds + i);
-			memoList[i] = new SmartList<String>;
 		}
 		std::string(&idsReff)[N] = ids;
 		SmartList<String>* (&memoReff)[N] = memoList;
 		multi_directional_search(idsReff, memoReff, func);
 
-		for (size_t i = 0; i < N; i++) {
-			SmartList<String>* path = memoReff[i];
-			DNode<String>* ptr = path->head;
-			while (ptr) {
-				memo[i].push_back(ptr->data->to_string());
-				ptr = ptr->next;
-			}
-		}
 		std::stringstream ss;
 		ss << "Mutlidirectional Search on " << this->type << " <"
 			<< this->graphId << "> finished. " << "Returned with{\n";
@@ -264,6 +530,17 @@ public:
 			return;
 		}
 
+		if (memo.size() < N) {
+			memo.resize(N);
+		}
+		for (size_t i = 0; i < N; i++) {
+			SmartList<String>* path = memoReff[i];
+			DNode<String>* ptr = path->head;
+			while (ptr) {
+				memo[i].push_back(ptr->data->to_string());
+				ptr = ptr->next;
+			}
+		}
 		for (int i = 0; i < N; i++) {
 			ss << "Start Id = " << startIds[i] << ": "
 				<< memoReff[i]->to_string() << "\n";
@@ -273,22 +550,14 @@ public:
 	}
 
 
-	/* Uses concurrent depth-first-searches to find a path from each startId ending at a common node. */
+	/* Uses concurrent breadth-first-searches to find a path from each startId ending at a common node. */
 	template<int N>
 	void multi_directional_search(std::string(&startIds)[N], std::vector<std::vector<std::string>>& memoIntersection, callType func = nullptr) {
 
 		std::cout << "\nBeginning multidirectional search..." << std::endl;
 		SmartList<String>* memoList[N]{};
-		multi_directional_search(startIds, memoList);
-		for (auto memo : memoList) {
-			DNode<String>* ptr = memo->head;
-			std::vector<std::string>* currPath = new std::vector<std::string>;
-			while (ptr) {
-				currPath->push_back(ptr->data->to_string());
-				ptr = ptr->next;
-			}
-			memoIntersection.push_back(*currPath);
-		}
+		multi_directional_search(startIds, memoList, func);
+
 		std::stringstream ss;
 		ss << "\nMutlidirectional Search on " << this->type << " <"
 			<< this->graphId << "> finished. " << "Returned with{\n";
@@ -299,6 +568,15 @@ public:
 			return;
 		}
 
+		for (auto memo : memoList) {
+			DNode<String>* ptr = memo->head;
+			std::vector<std::string>* currPath = new std::vector<std::string>;
+			while (ptr) {
+				currPath->push_back(ptr->data->to_string());
+				ptr = ptr->next;
+			}
+			memoIntersection.push_back(*currPath);
+		}
 		for (int i = 0; i < N; i++) {
 			ss << "Start Id = " << startIds[i] << ": "
 				<< memoList[i]->to_string() << "\n";
@@ -308,14 +586,117 @@ public:
 	}
 
 
+	/* Runs one breadth first search per start in lockstep until some node has been reached by all
+	of them. Every node keeps a bitmask of the searches that have reached it, a count of them, and
+	the node each search reached it from, so a meeting is noticed the moment it happens and the
+	paths are only rebuilt once. Returns false, leaving paths untouched, if the searches never meet;
+	otherwise paths[i] runs from startHandles[i] to the meeting node. */
+	bool multi_directional_search(const std::vector<uint32_t>& startHandles,
+		std::vector<std::vector<uint32_t>>& paths, callType func = nullptr);
+
+
+	template<typename Visitor, std::enable_if_t<is_graph_visitor<Visitor>, int> = 0>
+	bool multi_directional_search(const std::vector<uint32_t>& startHandles,
+		std::vector<std::vector<uint32_t>>& paths, Visitor visitor) {
+
+		for (uint32_t start : startHandles) {
+			if (!get_handle_node(start)) {
+				std::cerr << "Start node does not exist." << std::endl;
+				throw std::invalid_argument("Start node does not exist.");
+			}
+		}
+		size_t K = startHandles.size(), N = this->handles.size();
+		if (!K) { return false; }
+		size_t W = (K + 63) / 64;
+
+		// reachedBy holds W words per node; previous holds one row of N predecessors per search.
+		std::vector<uint64_t> reachedBy(N * W, 0);
+		std::vector<uint32_t> reachedCount(N, 0);
+		std::vector<uint32_t> previous(K * N, NULL_HANDLE);
+		std::vector<std::vector<uint32_t>> queues(K);
+		std::vector<size_t> heads(K, 0);
+		uint32_t meeting = NULL_HANDLE;
+
+		auto reach = [&](size_t search, uint32_t node, uint32_t from) -> bool {
+			uint64_t bit = uint64_t(1) << (search & 63);
+			uint64_t& word = reachedBy[node * W + (search >> 6)];
+			if (word & bit) { return false; }
+			if (visit(visitor, node)) { return true; }
+			word |= bit;
+			previous[search * N + node] = from;
+			queues[search].push_back(node);
+			if (++reachedCount[node] == K) {
+				meeting = node;
+				return true;
+			}
+			return false;
+		};
+
+		bool STOP_FLAG = false;
+		for (size_t i = 0; i < K && !STOP_FLAG; i++) {
+			STOP_FLAG = reach(i, startHandles[i], startHandles[i]);
+		}
+		while (!STOP_FLAG) {
+			bool active = false;
+			for (size_t i = 0; i < K && !STOP_FLAG; i++) {
+				if (heads[i] == queues[i].size()) { continue; }
+				active = true;
+				uint32_t curr = queues[i][heads[i]++];
+				DNode<Neighbor<GraphNode>>* childPtr = this->handles[curr]->children->head;
+				while (childPtr && !STOP_FLAG) {
+					STOP_FLAG = reach(i, childPtr->data->node->handle, curr);
+					childPtr = childPtr->next;
+				}
+			}
+			if (!active) { break; }
+		}
+		if (meeting == NULL_HANDLE) { return false; }
+
+		paths.assign(K, std::vector<uint32_t>());
+		for (size_t i = 0; i < K; i++) {
+			uint32_t curr = meeting;
+			paths[i].push_back(curr);
+			while (curr != startHandles[i]) {
+				curr = previous[i * N + curr];
+				paths[i].push_back(curr);
+			}
+			std::reverse(paths[i].begin(), paths[i].end());
+		}
+		return true;
+	}
+
+
 	void post_order_depth_first_search(const std::string& startId, std::vector<std::string>& memo);
 
 
-	/* Searches the nodes depth first, picking a node to start at and finding its further parent,
-	then starting the traversal from there. Repeats until all nodes are traversed. */
+	/* Searches the nodes depth first, one tree per unvisited root, until all nodes are traversed.
+	Nodes without parents are tried as roots first, then every other node, each in handle order,
+	so the whole forest takes O(V + E). Each inner list holds the nodes first reached from one root. */
 	void forest_depth_first_search(std::vector<std::vector<std::string>>& memo, callType func = nullptr);
 
 
+	/* Handle-based forest_depth_first_search with any visitor; appends one list per tree. */
+	template<typename Visitor, std::enable_if_t<is_graph_visitor<Visitor>, int> = 0>
+	void forest_depth_first_search(std::vector<std::vector<uint32_t>>& memo, Visitor visitor) {
+
+		std::vector<uint32_t> roots;
+		forest_roots(roots);
+		DepthFirstState state;
+		state.begin(this->handles.size());
+		for (uint32_t root : roots) {
+			if (state.discovered[root] == state.epoch) { continue; }
+			memo.emplace_back();
+			std::vector<uint32_t>& tree = memo.back();
+			depth_first_traversal(root, state,
+				[this, &tree, &visitor](uint32_t handle) {
+					tree.push_back(handle);
+					return visit(visitor, handle);
+				},
+				NoVisit(), NoVisit());
+		}
+	}
+
+
 	void forest_post_order_depth_first_search(std::vector<std::vector<std::string>>& memo);
 
 
@@ -323,6 +704,18 @@ public:
 	all of its parents. */
 	void topological_sort(std::string(&memo)[]);
 
+
+	/* Kahn's algorithm in O(V + E), split into wavefronts. Level 0 holds the nodes without parents
+	and every later level the nodes whose parents all sit in earlier levels, so the nodes of one
+	level never depend on each other. Each level is found in parallel from the one before it, by
+	counting down atomic in-degrees. The handles of level l are order[levelOffsets[l] ..
+	levelOffsets[l + 1]), sorted within the level, and order as a whole is a topological order.
+	Returns false if the graph has a cycle; order then holds only the nodes that could be placed,
+	and cycle, if given, receives one cycle as handles in edge order. Zero threads means one per
+	hardware thread. */
+	bool topological_levels(std::vector<uint32_t>& order, std::vector<uint32_t>& levelOffsets,
+		std::vector<uint32_t>* cycle = nullptr, size_t threads = 0) const;
+
 	
 	/* Transposes the graph in-place. */
 	void transpose();
@@ -332,17 +725,253 @@ public:
 	strongly connected iff ∀v, w ∈ U, ∃ path (v, . . ., w) contained in (U, E_U). */
 	void kosarajus_algorithm(std::vector<std::vector<std::string>>& memo);
 
+
+	/* Strongly connected components in a single O(V + E) pass that leaves the graph untouched, so
+	it can run alongside readers. Uses Pearce's variant of Tarjan's algorithm over an explicit
+	stack, with one dense rindex array in place of separate index and low-link arrays. component[v]
+	is the component of handle v, and the handles of component c are members[offsets[c] ..
+	offsets[c + 1]). Components are numbered in reverse topological order: every edge leads to a
+	component numbered no higher than its own. Returns the number of components. If cancelled is
+	given and turns true, the search stops at the next node it would visit, clears the arrays and
+	returns 0. */
+	size_t strongly_connected_components(std::vector<uint32_t>& component, std::vector<uint32_t>& offsets,
+		std::vector<uint32_t>& members, const std::atomic<bool>* cancelled = nullptr) const;
+
+
+	void strongly_connected_components(std::vector<std::vector<std::string>>& components) const;
+
+
+	/* Multithreaded strongly connected components for large graphs, filling the same arrays as
+	strongly_connected_components. First nodes with no live parents or no live children are
+	trimmed off as single components, round after round. The giant component is then taken in
+	one step as the intersection of parallel forward and backward searches from the node with
+	the largest in-degree * out-degree. What remains is split by coloring: each node takes the
+	largest handle that reaches it, and every node whose color is its own handle grows its
+	component backward through its color, all colors at once. Component numbers follow the
+	order components are found in, which is not topological. Zero threads means one per
+	hardware thread. */
+	size_t parallel_strongly_connected_components(std::vector<uint32_t>& component, std::vector<uint32_t>& offsets,
+		std::vector<uint32_t>& members, size_t threads = 0) const;
+
 	
 	void dijsktras_algorithm(const std::string& startId, std::map<std::string, std::string>& previous);
 
 
-	void shortest_path(const std::string& startId, const std::string endId, std::vector<std::string>& shortestPath, double& weight);
+	/* Dijkstra over a flat indexed 4-ary heap. Nodes enter the heap only when first discovered, and
+	the search stops as soon as targetHandle (if given) is settled. Fills distance and previous by
+	handle; unreached nodes stay at INFINITY and NULL_HANDLE. Unweighted edges count as 1. With
+	reverse set the search follows parents, giving distances to startHandle rather than from it.
+	Returns the number of settled nodes. */
+	size_t dijsktras_algorithm(uint32_t startHandle, std::vector<double>& distance,
+		std::vector<uint32_t>& previous, uint32_t targetHandle = NULL_HANDLE, bool reverse = false);
+
+
+	/* Parallel delta-stepping single source shortest paths. Nodes sit in buckets of width delta;
+	each bucket's light edges (weight <= delta) are relaxed by the thread pool in rounds until the
+	bucket stops refilling, and then its heavy edges once. Distances are lowered with atomic
+	compare-and-swap, so threads never lock. A delta of zero or less uses the mean edge weight.
+	Fills distance by handle; unreached nodes stay at INFINITY. */
+	void delta_stepping(uint32_t startHandle, std::vector<double>& distance, double delta = 0,
+		size_t threads = 0);
+
+
+	/* A* search from startHandle to goalHandle. heuristic is any callable taking a handle or a
+	const GraphNode& and returning a lower bound on the remaining weight to the goal; being a
+	template argument it is inlined into the search loop. The path is shortest whenever the
+	heuristic never overestimates. A node already expanded is reopened if a lighter route to it
+	turns up, which only happens when the heuristic is not consistent; with a consistent one, such
+	as straight-line distance over coordinates, every node is expanded at most once. Nodes estimated at
+	INFINITY are treated as unable to reach the goal and never queued. Fills path from start to
+	goal and returns its weight, or INFINITY with an empty path. settled, if given, receives the
+	number of nodes expanded. */
+	template<typename Heuristic>
+	double a_star(uint32_t startHandle, uint32_t goalHandle, std::vector<uint32_t>& path,
+		Heuristic heuristic, size_t* settled = nullptr) {
+
+		if (!get_handle_node(startHandle) || !get_handle_node(goalHandle)) {
+			std::cerr << "A* search not run: Node does not exist." << std::endl;
+			throw std::invalid_argument("Node does not exist.");
+		}
+		size_t N = this->handles.size();
+		std::vector<double> distance(N, INFINITY), estimate(N, NAN);
+		std::vector<uint32_t> previous(N, NULL_HANDLE);
+		IndexedHeap<4> remaining(N);
+
+		distance[startHandle] = 0;
+		previous[startHandle] = startHandle;
+		remaining.push(startHandle, estimate_remaining(heuristic, startHandle, estimate));
+		size_t expanded = 0;
+
+		while (!remaining.is_empty()) {
+			uint32_t curr = remaining.pop();
+			expanded++;
+			if (curr == goalHandle) { break; }
+
+			DNode<Neighbor<GraphNode>>* child = this->handles[curr]->children->head;
+			while (child) {
+				uint32_t childHandle = child->data->node->handle;
+				double routedWeight = distance[curr] + edge_weight(child->data);
+				// An expanded node is queued again by a lighter route, reopening it.
+				if (routedWeight < distance[childHandle]) {
+					// An infinite estimate means the goal cannot be reached from this node.
+					double remainingWeight = estimate_remaining(heuristic, childHandle, estimate);
+					if (remainingWeight != INFINITY) {
+						distance[childHandle] = routedWeight;
+						previous[childHandle] = curr;
+						remaining.push_or_decrease(childHandle, routedWeight + remainingWeight);
+					}
+				}
+				child = child->next;
+			}
+		}
+		if (settled) { *settled = expanded; }
+
+		path.clear();
+		if (previous[goalHandle] == NULL_HANDLE) {
+			return INFINITY;
+		}
+		for (uint32_t curr = goalHandle; curr != startHandle; curr = previous[curr]) {
+			path.push_back(curr);
+		}
+		path.push_back(startHandle);
+		std::reverse(path.begin(), path.end());
+		return distance[goalHandle];
+	}
+
+
+	template<typename Heuristic>
+	double a_star(const std::string& startId, const std::string& goalId, std::vector<std::string>& path,
+		Heuristic heuristic, size_t* settled = nullptr) {
+
+		GraphNode* start = get_node(startId), * goal = get_node(goalId);
+		if (!start || !goal) {
+			std::cerr << "A* search not run: Node does not exist." << std::endl;
+			throw std::invalid_argument("Node does not exist.");
+		}
+		std::vector<uint32_t> handlePath;
+		double weight = a_star(start->handle, goal->handle, handlePath, heuristic, settled);
+		for (uint32_t handle : handlePath) {
+			path.push_back(this->handles[handle]->id.to_string());
+		}
+		return weight;
+	}
+
+
+	/* With bidirectional set, searches forward from startId and backward from endId at once
+	instead of building a full shortest path tree from startId. */
+	void shortest_path(const std::string& startId, const std::string endId, std::vector<std::string>& shortestPath, double& weight,
+		bool bidirectional = false);
 
 
-	void shortest_path(const std::string& startId, const std::string endId, SmartList<String>& shortestPath, double& weight);
+	void shortest_path(const std::string& startId, const std::string endId, SmartList<String>& shortestPath, double& weight,
+		bool bidirectional = false);
+
+
+	/* Point-to-point search that grows a forward search over children from startHandle and a
+	backward search over parents from endHandle, always advancing the smaller side. Weighted graphs
+	run Dijkstra from both ends and stop once the two heap minima together reach the best meeting
+	found; unweighted graphs run breadth first level by level and stop after the first level in
+	which the searches meet. Fills path from start to end and returns its weight, or INFINITY with
+	an empty path. settled, if given, receives the number of nodes expanded. */
+	double bidirectional_search(uint32_t startHandle, uint32_t endHandle, std::vector<uint32_t>& path,
+		size_t* settled = nullptr);
+
+
+	/* Shortest path weights from every source to every target, filled row-major so that
+	distances[i * targets.size() + j] is the weight from sources[i] to targets[j], or INFINITY.
+	Each distinct source is searched once, stopping as soon as all targets are settled, and the
+	sources are spread across threads. paths, if given, receives the matching path for each cell;
+	zero threads means one per hardware thread. */
+	void many_to_many(const std::vector<uint32_t>& sourceHandles, const std::vector<uint32_t>& targetHandles,
+		std::vector<double>& distances, std::vector<std::vector<uint32_t>>* paths = nullptr, size_t threads = 0);
+
+
+	void many_to_many(const std::vector<std::string>& sourceIds, const std::vector<std::string>& targetIds,
+		std::vector<double>& distances, std::vector<std::vector<std::string>>* paths = nullptr, size_t threads = 0);
+
+
+	/* Answers independent (start, end) queries in one batch. Queries are grouped by start so each
+	distinct start is searched once for all of its ends. weights[i] and, if given, paths[i] hold
+	the answer to queries[i]. */
+	void shortest_paths(const std::vector<std::pair<uint32_t, uint32_t>>& queries, std::vector<double>& weights,
+		std::vector<std::vector<uint32_t>>* paths = nullptr, size_t threads = 0);
+
+
+	/* Yen's k shortest loopless paths from startHandle to endHandle, in order of weight. Fills
+	paths and weights with up to k entries; fewer if the graph has fewer distinct loopless paths.
+	Spur searches mask the root path's nodes and the already used next edges rather than changing
+	the graph, and the spur searches of each round run in parallel. Zero threads means one per
+	hardware thread. */
+	void k_shortest_paths(uint32_t startHandle, uint32_t endHandle, size_t k,
+		std::vector<std::vector<uint32_t>>& paths, std::vector<double>& weights, size_t threads = 0);
+
+
+	void k_shortest_paths(const std::string& startId, const std::string& endId, size_t k,
+		std::vector<std::vector<std::string>>& paths, std::vector<double>& weights, size_t threads = 0);
+
+
+	/* Lazy breadth first search, yielding handles in the order breadth_first_search records them.
+	Each node's children are only scanned once the caller has taken everything before them, so
+	stopping early skips the rest of the search. The graph must not change while the generator
+	is in use. */
+	Generator<uint32_t> bfs(uint32_t startHandle) const;
+
+
+	Generator<uint32_t> bfs(const std::string& startId) const;
+
+
+	/* Lazy depth first search, yielding handles in the pre-order of depth_first_search. */
+	Generator<uint32_t> dfs(uint32_t startHandle) const;
+
+
+	Generator<uint32_t> dfs(const std::string& startId) const;
+
+
+	/* Lazy topological order by Kahn's algorithm, yielding each node once all of its parents have
+	been yielded. If the graph has a cycle, it throws once only nodes on or behind a cycle are
+	left. */
+	Generator<uint32_t> topo() const;
+
+
+	/* Builds an immutable Compressed Sparse Row copy of the graph, indexed by handle, for
+	read-heavy analytics. Later changes to the graph are not reflected in the snapshot. */
+	CSRGraph* to_csr() const;
 
 protected:
 
+	// The coroutines behind bfs and dfs, which check the start eagerly before the lazy part.
+	Generator<uint32_t> bfs_from(uint32_t startHandle) const;
+
+
+	Generator<uint32_t> dfs_from(uint32_t startHandle) const;
+
+
+	// Calls visitor with handle or with its node, whichever it takes, and returns whether it
+	// asked to stop.
+	template<typename Visitor>
+	bool visit(Visitor& visitor, uint32_t handle) const {
+		if constexpr (std::is_invocable_v<Visitor&, uint32_t>) {
+			if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, uint32_t>>) {
+				visitor(handle);
+				return false;
+			}
+			else {
+				return static_cast<bool>(visitor(handle));
+			}
+		}
+		else {
+			const GraphNode& node = *this->handles[handle];
+			if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, const GraphNode&>>) {
+				visitor(node);
+				return false;
+			}
+			else {
+				return static_cast<bool>(visitor(node));
+			}
+		}
+	}
+
+
 	void validate_weight(bool weight);
 
 
@@ -379,12 +1008,29 @@ protected:
 	virtual GraphNode* get_node(String& id) const;
 
 
+	GraphNode* get_handle_node(uint32_t handle) const;
+
+
+	// Assigns the next free handle to a freshly created node. Every create_node must call this.
+	void register_node(GraphNode* node);
+
+
+	// Releases a node's handle, moving the last node into the freed slot to keep handles dense.
+	void unregister_node(GraphNode* node);
+
+
 	virtual void create_node(const std::string& id, const bool weighted = false);
 
 
 	virtual Neighbor<GraphNode>* create_neighbor(GraphNode* node, double weight = -1);
 
 
+	void connect_nodes(GraphNode* parent, GraphNode* child, double parent_to_child_weight = -1);
+
+
+	void disconnect_nodes(GraphNode* parent, GraphNode* child);
+
+
 	void remove_edge(String& parentId, String& childId);
 
 
@@ -418,15 +1064,7 @@ protected:
 	}
 
 
-	static bool depth_traverse_memo_stopcall(
-		String&						id,
-		callType					func,
-		SmartList<String>*	memo,
-		int*						rcarg,
-		std::string					title
-	);
-
-
+	// Nodes already in memo are treated as searched and not entered again.
 	void depth_first_search(const std::string& startId, SmartList<String>* memo, callType func = nullptr);
 
 
@@ -439,14 +1077,15 @@ protected:
 		memoType					memo, 
 		kwargs						...args) {
 		
-		Queue<String>* toVisitNeighborsArray[N]{};
-		SmartList<String>* visitedArray[N]{};
+		Queue<GraphNode>* toVisitNeighborsArray[N]{};
+		// Indexed by handle, so checking a node costs O(1) rather than a scan of the visited list.
+		std::vector<bool> visitedArray[N];
 		bool STOP_FLAG = false;
 
 		for (int i = 0; i < N; i++) {
-			toVisitNeighborsArray[i] = new Queue<String>();
-			visitedArray[i] = new SmartList<String>();
-			STOP_FLAG = memostopcall(get_node(startIds[i])->id, *(new String("")), i, 
+			toVisitNeighborsArray[i] = new Queue<GraphNode>();
+			visitedArray[i].assign(this->handles.size(), false);
+			STOP_FLAG = memostopcall(*get_node(startIds[i]), *(new String("")), i, 
 				call, toVisitNeighborsArray[i], visitedArray, memo, args...);
 			if (STOP_FLAG) { return; }
 		}
@@ -461,12 +1100,11 @@ protected:
 
 		while (!STOP_FLAG) {
 			for (int i = 0; i < N; i++) {
-				String* nextInQueue = toVisitNeighborsArray[i]->dequeue();
-				if (nextInQueue) {
-					GraphNode* nextNode = get_node(*nextInQueue);
+				GraphNode* nextNode = toVisitNeighborsArray[i]->dequeue();
+				if (nextNode) {
 					DNode<Neighbor<GraphNode>>* childPtr = nextNode->children->head;
 					while (childPtr) {
-						STOP_FLAG = memostopcall(childPtr->data->node->id, *nextInQueue, i, call, 
+						STOP_FLAG = memostopcall(*childPtr->data->node, nextNode->id, i, call, 
 							toVisitNeighborsArray[i], visitedArray, memo, args...);
 						if (STOP_FLAG) { return; }
 						childPtr = childPtr->next;
@@ -489,12 +1127,12 @@ protected:
 	static bool breadth_search_memo_stopcall(
 
 		// args from breadth traverse scope
-		String&						currId, 
+		GraphNode&					currNode, 
 		String&						lastId,				// not used but passed to memo_stopcall by breadth_traverse
 		int							index, 
 		callType					call, 
-		Queue<String>*				toVisitNeighbors, 
-		SmartList<String>*	(& visitedArray)[N], 
+		Queue<GraphNode>*			toVisitNeighbors, 
+		std::vector<bool>	(& visitedArray)[N], 
 		SmartList<String>*	(& memo)[N], 
 
 		// variadic args from breadth_first_search scope
@@ -503,12 +1141,13 @@ protected:
 
 
 		bool STOP_FLAG = false;
-		if (!visitedArray[index]->contains_ref(&currId)) {
+		String& currId = currNode.id;
+		if (!visitedArray[index][currNode.handle]) {
 			STOP_FLAG = call(currId.to_string());
 			if (STOP_FLAG) { return STOP_FLAG;  }
-			visitedArray[index]->append(currId);
+			visitedArray[index][currNode.handle] = true;
 			memo[index]->append(currId);
-			toVisitNeighbors->enqueue(currId);
+			toVisitNeighbors->enqueue(currNode);
 		}
 		return STOP_FLAG;
 	}
@@ -517,17 +1156,51 @@ protected:
 	void breadth_first_search(const std::string& startId, SmartList<String>* memo, callType func = nullptr);
 
 
+	// One top-down level of parallel_breadth_first_search. Returns the out-degree sum of next.
+	size_t top_down_step(ThreadPool& pool, std::vector<uint32_t>& frontier, std::vector<uint32_t>& next,
+		AtomicBitmap& visited, std::vector<uint32_t>& parent, std::vector<uint32_t>& distance, uint32_t level);
+
+
+	// One bottom-up level of parallel_breadth_first_search. Returns the out-degree sum of next.
+	size_t bottom_up_step(ThreadPool& pool, std::vector<uint32_t>& frontier, std::vector<uint32_t>& next,
+		AtomicBitmap& visited, std::vector<uint32_t>& parent, std::vector<uint32_t>& distance, uint32_t level);
+
+
+	// One MS-BFS batch of at most MS_BFS_WIDTH searches, starting at startHandles[first].
+	void multi_source_batch(const std::vector<uint32_t>& startHandles, size_t first, size_t batchSize,
+		std::vector<std::vector<uint32_t>>& distances);
+
+
+	static const size_t MS_BFS_WIDTH = 256;
+
+
+	// Repeatedly labels live nodes with no live parents or no live children as components of
+	// their own, marking them done.
+	void trim_components(ThreadPool& pool, AtomicBitmap& done, std::vector<uint32_t>& component,
+		std::atomic<uint32_t>& componentCount, std::vector<uint32_t>& inDegree, std::vector<uint32_t>& outDegree) const;
+
+
+	// Parallel breadth first search from start over children (or parents) that are not done.
+	void restricted_reach(ThreadPool& pool, uint32_t start, bool parents, const AtomicBitmap& done,
+		AtomicBitmap& reached) const;
+
+
+	// Sorts handles into contiguous per-component runs.
+	static void group_components(const std::vector<uint32_t>& component, size_t componentCount,
+		std::vector<uint32_t>& offsets, std::vector<uint32_t>& members);
+
+
 	template<int N>
 	void breadth_first_search(const std::string(&startIds)[N], SmartList<String>* (&memo)[N],
 		callType func=nullptr) {
 
 		typedef bool (*BFSmemoStopCallType)(
-			String&, 
+			GraphNode&, 
 			String&, 
 			int, 
 			callType,
-			Queue<String>*, 
-			SmartList<String>* (&)[N], 
+			Queue<GraphNode>*, 
+			std::vector<bool> (&)[N], 
 			SmartList<String>* (&)[N],
 			int*, 
 			std::string
@@ -551,130 +1224,42 @@ protected:
 
 
 	template<int N>
-	static bool multi_directional_memo_stopcall(
-		// args from breadth traverse scope
-		String&										currId,
-		String&										lastId,				
-		int											index,
-		callType									call,
-		Queue<String>*								toVisitNeighbors,
-		SmartList<String>*					(&visitedArray)[N],				
-		HashTable<SmartList<String>>*		(&memo_paths)[N],
-
-		// variadic args from multi_directional_search scope
-		SmartList<String>*					(&memo_intersection)[N],
-		int*										callNum,
-		std::string									title) {
-		
-		bool STOP_FLAG = false;
-
-		if (!visitedArray[index]->contains_ref(&currId)) {
-			STOP_FLAG = call(currId.to_string());
-			if (STOP_FLAG) { return STOP_FLAG; }
-			visitedArray[index]->append(currId);
-			toVisitNeighbors->enqueue(currId);
-
-			if (lastId.to_string() == "") {
-				HashTable<SmartList<String>>* newMemo = new HashTable<SmartList<String>>();
-				memo_paths[index] = newMemo;
-				SmartList<String>* newPath = new SmartList<String>();
-				newPath->append(currId);
-				memo_paths[index]->put(currId.to_string(), *newPath);
-			}
-			else {
-				SmartList<String>* currPath = memo_paths[index]->get(lastId.to_string());
-				SmartList<String>* newPath = currPath->copy();
-				newPath->append(currId);
-				memo_paths[index]->put(currId.to_string(), *newPath);
-			}
-		}
-
-		SmartList<String>* ids = memo_paths[0]->keys();
-		SmartList<String>* intersection = ids;
+	void multi_directional_search(std::string (&startIds)[N], SmartList<String>* (&memo_intersection)[N],
+		callType func = nullptr) {
 
-		bool hasIntersect = false;
-		for (int i = 0; i < N - 1; i++) {
-			if (memo_paths[i + 1]) {
-				intersection = intersection->cap(memo_paths[i + 1]->keys());
-				if (!intersection->head) {
-					hasIntersect = false;
-					break;
-				}
-				else { if (i == N - 2) { hasIntersect = true; } }
-			}
-			else {
-				break;
-			}
+		std::vector<uint32_t> startHandles;
+		for (int i = 0; i < N; i++) {
+			startHandles.push_back(get_node(startIds[i])->handle);
 		}
+		std::vector<std::vector<uint32_t>> paths;
+		if (!multi_directional_search(startHandles, paths, func)) { return; }
 
-		if (hasIntersect) {
-			STOP_FLAG = true;
-			String commonNode = *intersection->head->data;
-			for (int i = 0; i < N; i++) {
-				memo_intersection[i] = memo_paths[i]->get(commonNode.to_string());
+		for (int i = 0; i < N; i++) {
+			memo_intersection[i] = new SmartList<String>;
+			for (uint32_t handle : paths[i]) {
+				memo_intersection[i]->append(this->handles[handle]->id);
 			}
 		}
-
-		return STOP_FLAG;
-	}
-
-
-	template<int N>
-	void multi_directional_search(std::string (&startIds)[N], SmartList<String>* (&memo_intersection)[N]) {
-
-		typedef bool (*MDSmemoStopCallType)(
-			String&,
-			String&, 
-			int, 
-			callType,
-			Queue<String>*, 
-			SmartList<String>* (&)[N], 
-			HashTable<SmartList<String>>* (&)[N],
-			SmartList<String>* (&)[N],
-			int*, 
-			std::string
-		);
-
-		MDSmemoStopCallType MDSmemoStopCallPtr = &Graph::multi_directional_memo_stopcall;
-		callType funcPtr = &Graph::doNothing;
-
-		int* ptr = new int(0);
-
-		HashTable<SmartList<String>>* memo_paths[N]{};
-
-		breadth_traverse<N, MDSmemoStopCallType, callType, 
-			HashTable<SmartList<String>>* (&)[N],
-			SmartList<String>* (&)[N], int*, std::string>(
-				startIds,
-				MDSmemoStopCallPtr,
-				funcPtr,
-				memo_paths,
-
-				memo_intersection,
-				ptr,
-				graphId
-			);
 	}
 
 	// this function is very dangerous, use with caution. 
 	static bool doNothing(const std::string& id) { return false;}
 
 
-	bool topological_sort_helper(String& currId, SmartList<String>* path, SmartList<String>* seen, Stack<String>* sorted);
-
-
 	// If possible, returns a topologically-sorted list of the nodes; where each node supercedes 
 	// all of its parents. 
 	void topological_sort(SmartList<String>* memo);
 
 
+	// Nodes already in seen are skipped, and every node searched is added to it.
 	void post_order_depth_first_search(String& startId, SmartList<String>* memo, SmartList<String>* seen);
 
 
 	virtual void forest_post_order_depth_first_search(SmartList<SmartList<String>>* memo);
 
 
-	int find_furthest_parent(String& id, SmartList<String>* path, int currDistance, String* memo);
+	// Roots for the forest traversals: nodes without parents, then all the others.
+	void forest_roots(std::vector<uint32_t>& roots) const;
 
 
 	virtual void forest_depth_first_search(SmartList<SmartList<String>>* memo, callType func = nullptr);
@@ -703,6 +1288,133 @@ protected:
 
 
 	void dijsktras_algorithm(const std::string& startId, HashTable<String>& pathToNodeWeight);
+
+
+	double bidirectional_dijkstra(uint32_t startHandle, uint32_t endHandle, std::vector<uint32_t>& path,
+		size_t* settled);
+
+
+	double bidirectional_breadth_first_search(uint32_t startHandle, uint32_t endHandle,
+		std::vector<uint32_t>& path, size_t* settled);
+
+
+	// Joins the forward predecessors and backward successors of a meeting node into one path.
+	void join_bidirectional_path(uint32_t startHandle, uint32_t endHandle, uint32_t meeting,
+		std::vector<uint32_t>& previous, std::vector<uint32_t>& next, std::vector<uint32_t>& path);
+
+
+	// Per-thread state for running many Dijkstra searches back to back. Only the entries a search
+	// touched are reset afterwards, so short searches on large graphs stay cheap.
+	struct SearchScratch {
+		std::vector<double> distance;
+		std::vector<uint32_t> previous;
+		std::vector<uint32_t> touched;
+		std::vector<uint32_t> targetStamp;
+		uint32_t stamp = 0;
+		IndexedHeap<4> remaining;
+
+		SearchScratch(size_t size) : distance(size, INFINITY), previous(size, NULL_HANDLE),
+			targetStamp(size, 0), remaining(size) {}
+	};
+
+
+	/* Runs one search per group, where group g starts at starts[g] and asks for the targets
+	entryTargets[offsets[g] .. offsets[g + 1]), writing each answer to weights[entrySlots[e]] and
+	(if paths) paths[entrySlots[e]]. Groups are handed out to the thread pool. */
+	void batch_dijkstra(const std::vector<uint32_t>& starts, const std::vector<size_t>& offsets,
+		const std::vector<uint32_t>& entryTargets, const std::vector<size_t>& entrySlots,
+		std::vector<double>& weights, std::vector<std::vector<uint32_t>>* paths, size_t threads);
+
+
+	// Edge filter for multi_target_dijkstra that lets every edge through.
+	struct AllowAllEdges {
+		bool operator()(uint32_t, uint32_t) const { return true; }
+	};
+
+
+	/* Dijkstra from start that stops once all targetCount targets are settled, only following the
+	edges for which allowed(parent, child) is true. Being a template argument, the filter is
+	inlined into the relaxation loop, so searches can mask nodes and edges without touching the
+	graph. Without a filter every edge is followed. */
+	template<typename EdgeFilter = AllowAllEdges>
+	void multi_target_dijkstra(uint32_t start, const uint32_t* targets, size_t targetCount,
+		SearchScratch& scratch, EdgeFilter allowed = EdgeFilter()) {
+
+		if (++scratch.stamp == 0) {
+			std::fill(scratch.targetStamp.begin(), scratch.targetStamp.end(), 0);
+			scratch.stamp = 1;
+		}
+		size_t unsettled = 0;
+		for (size_t i = 0; i < targetCount; i++) {
+			if (scratch.targetStamp[targets[i]] != scratch.stamp) {
+				scratch.targetStamp[targets[i]] = scratch.stamp;
+				unsettled++;
+			}
+		}
+
+		scratch.distance[start] = 0;
+		scratch.previous[start] = start;
+		scratch.touched.push_back(start);
+		scratch.remaining.push(start, 0);
+
+		while (unsettled && !scratch.remaining.is_empty()) {
+			uint32_t curr = scratch.remaining.pop();
+			if (scratch.targetStamp[curr] == scratch.stamp) { unsettled--; }
+
+			double currWeight = scratch.distance[curr];
+			DNode<Neighbor<GraphNode>>* child = this->handles[curr]->children->head;
+			while (child) {
+				uint32_t childHandle = child->data->node->handle;
+				double routedWeight = currWeight + edge_weight(child->data);
+				if (routedWeight < scratch.distance[childHandle] && allowed(curr, childHandle)) {
+					if (scratch.distance[childHandle] == INFINITY) { scratch.touched.push_back(childHandle); }
+					scratch.distance[childHandle] = routedWeight;
+					scratch.previous[childHandle] = curr;
+					scratch.remaining.push_or_decrease(childHandle, routedWeight);
+				}
+				child = child->next;
+			}
+		}
+	}
+
+
+	void reset_scratch(SearchScratch& scratch);
+
+
+	// Relaxes the light or heavy edges of every node in frontier in parallel, collecting the nodes
+	// whose distance dropped in found.
+	void relax_delta_edges(ThreadPool& pool, std::vector<uint32_t>& frontier, std::atomic<double>* distance,
+		double delta, bool light, std::vector<std::vector<uint32_t>>& found);
+
+
+	// Lowers target to value if value is smaller; returns whether it did.
+	static bool atomic_min(std::atomic<double>& target, double value) {
+		double curr = target.load(std::memory_order_relaxed);
+		while (value < curr) {
+			if (target.compare_exchange_weak(curr, value, std::memory_order_relaxed)) { return true; }
+		}
+		return false;
+	}
+
+
+	// Evaluates the heuristic once per node, caching the result in estimate.
+	template<typename Heuristic>
+	double estimate_remaining(Heuristic& heuristic, uint32_t handle, std::vector<double>& estimate) const {
+		if (std::isnan(estimate[handle])) {
+			if constexpr (std::is_invocable_v<Heuristic&, const GraphNode&>) {
+				estimate[handle] = heuristic(static_cast<const GraphNode&>(*this->handles[handle]));
+			}
+			else {
+				estimate[handle] = heuristic(handle);
+			}
+		}
+		return estimate[handle];
+	}
+
+
+	double edge_weight(const Neighbor<GraphNode>* neighbor) const {
+		return this->weighted ? neighbor->weight : 1;
+	}
 };
 
 
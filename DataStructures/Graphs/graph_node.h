@@ -1,6 +1,10 @@
 #pragma once
 #include "../lists.h"
 #include <string>
+#include <cstdint>
+
+// Sentinel for a node that has not been registered with a graph.
+const uint32_t NULL_HANDLE = UINT32_MAX;
 
 template<typename T>
 struct Neighbor {
@@ -24,6 +28,7 @@ public:
 
 	std::string type = "GraphNode";
 	String id;
+	uint32_t handle = NULL_HANDLE;
 	bool weighted;
 	SmartList<Neighbor<GraphNode>>* children;
 	SmartList<Neighbor<GraphNode>>* parents;
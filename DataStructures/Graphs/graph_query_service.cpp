@@ -0,0 +1,105 @@
+#include "graph_query_service.h"
+#include "../thread_pool.h"
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+
+GraphQueryService::GraphQueryService(Graph& graph, size_t threads, size_t maxPending) :
+	graph(&graph), maxPending(maxPending), pool(threads) {
+
+	if (!this->maxPending) { this->maxPending = 4 * pool.size; }
+}
+
+
+std::future<std::vector<uint32_t>> GraphQueryService::breadth_first_search(uint32_t startHandle,
+	CancellationToken token) {
+
+	// Made here so a bad start throws to the caller rather than from the future.
+	Generator<uint32_t> nodes = graph->bfs(startHandle);
+	return submit([nodes = std::move(nodes), token]() mutable {
+		std::vector<uint32_t> order;
+		for (uint32_t v : nodes) {
+			token.throw_if_cancelled();
+			order.push_back(v);
+		}
+		return order;
+	});
+}
+
+
+std::future<std::vector<uint32_t>> GraphQueryService::depth_first_search(uint32_t startHandle,
+	CancellationToken token) {
+
+	Generator<uint32_t> nodes = graph->dfs(startHandle);
+	return submit([nodes = std::move(nodes), token]() mutable {
+		std::vector<uint32_t> order;
+		for (uint32_t v : nodes) {
+			token.throw_if_cancelled();
+			order.push_back(v);
+		}
+		return order;
+	});
+}
+
+
+std::future<GraphQueryService::PathResult> GraphQueryService::shortest_path(uint32_t startHandle, uint32_t endHandle,
+	CancellationToken token) {
+
+	check_handle(startHandle, "Shortest path");
+	check_handle(endHandle, "Shortest path");
+	return submit([this, startHandle, endHandle, token]() {
+		PathResult result;
+		// A zero estimate makes A* a plain Dijkstra search; it is asked once per node reached,
+		// which is where the token gets checked.
+		result.weight = graph->a_star(startHandle, endHandle, result.path, [&token](uint32_t) {
+			token.throw_if_cancelled();
+			return 0.0;
+		});
+		token.throw_if_cancelled();
+		return result;
+	});
+}
+
+
+std::future<GraphQueryService::Components> GraphQueryService::strongly_connected_components(CancellationToken token) {
+
+	return submit([this, token]() {
+		Components result;
+		result.count = graph->strongly_connected_components(result.component, result.offsets, result.members,
+			token.flag.get());
+		token.throw_if_cancelled();
+		return result;
+	});
+}
+
+
+size_t GraphQueryService::pending_queries() {
+	std::lock_guard<std::mutex> guard(lock);
+	return pending;
+}
+
+
+std::string GraphQueryService::to_string() {
+	std::stringstream ss;
+	ss << "__GraphQueryService__{threads: " << pool.size << ", pending: " << pending_queries()
+		<< ", max pending: " << maxPending << "}";
+	return ss.str();
+}
+
+
+void GraphQueryService::release() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		pending--;
+	}
+	slotFree.notify_one();
+}
+
+
+void GraphQueryService::check_handle(uint32_t handle, const char* query) {
+	if (handle >= graph->handle_count()) {
+		std::cerr << query << " not run: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "graph.h"
+#include "../thread_pool.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <cstdint>
+
+
+// Thrown out of a query's future when its token was cancelled before the query finished.
+class QueryCancelled : public std::runtime_error {
+
+public:
+
+	QueryCancelled() : std::runtime_error("Query cancelled.") {}
+};
+
+
+/* Shared flag that asks the queries holding it to stop. Copies share one flag, so the caller
+keeps a copy and cancels it while the query's copy is checked from the worker. */
+class CancellationToken {
+
+public:
+
+	std::shared_ptr<std::atomic<bool>> flag;
+
+	CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+
+	void cancel() const {
+		flag->store(true, std::memory_order_relaxed);
+	}
+
+
+	bool is_cancelled() const {
+		return flag->load(std::memory_order_relaxed);
+	}
+
+
+	void throw_if_cancelled() const {
+		if (is_cancelled()) { throw QueryCancelled(); }
+	}
+};
+
+
+/* Runs read-only queries on a graph in the background and hands back futures. Queries share one
+thread pool, and at most maxPending of them may be queued or running at once; submitting
+another blocks the caller until one finishes, so a burst of requests can't grow the queue
+without bound. Each query keeps its own traversal state, so any number can run side by side.
+A query checks its token at every node it reaches and, once cancelled, stops and makes its
+future throw QueryCancelled. A query that fails any other way rethrows from its future.
+
+Start handles are checked when the query is submitted. The graph must not change while queries
+are pending; the destructor waits for every submitted query to finish. */
+class GraphQueryService {
+
+public:
+
+	struct PathResult {
+		// INFINITY with an empty path when the end can't be reached.
+		double weight = INFINITY;
+		std::vector<uint32_t> path;
+	};
+
+	// The arrays filled by Graph::strongly_connected_components.
+	struct Components {
+		size_t count = 0;
+		std::vector<uint32_t> component;
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> members;
+	};
+
+	Graph* graph;
+	size_t maxPending;
+
+protected:
+
+	std::mutex lock;
+	std::condition_variable slotFree;
+	size_t pending = 0;
+	// Declared last so it's destroyed first, draining the queries before what they touch goes.
+	ThreadPool pool;
+
+public:
+
+	/* Zero threads means one per hardware thread; zero maxPending means four per thread. */
+	GraphQueryService(Graph& graph, size_t threads = 0, size_t maxPending = 0);
+
+
+	/* Handles in the order a breadth first search from startHandle reaches them. */
+	std::future<std::vector<uint32_t>> breadth_first_search(uint32_t startHandle,
+		CancellationToken token = CancellationToken());
+
+
+	/* Handles in the order a depth first search from startHandle reaches them. */
+	std::future<std::vector<uint32_t>> depth_first_search(uint32_t startHandle,
+		CancellationToken token = CancellationToken());
+
+
+	/* Lightest path from startHandle to endHandle and its weight. */
+	std::future<PathResult> shortest_path(uint32_t startHandle, uint32_t endHandle,
+		CancellationToken token = CancellationToken());
+
+
+	/* Strongly connected components of the whole graph. */
+	std::future<Components> strongly_connected_components(CancellationToken token = CancellationToken());
+
+
+	// Queries submitted and not yet finished.
+	size_t pending_queries();
+
+
+	std::string to_string();
+
+protected:
+
+	/* Waits for a free slot, then queues query on the pool. The slot is given back when the
+	query returns or throws. */
+	template<typename F>
+	auto submit(F query) -> std::future<decltype(query())> {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			slotFree.wait(guard, [this]() { return pending < maxPending; });
+			pending++;
+		}
+		return pool.submit([this, query = std::move(query)]() mutable {
+			struct Release {
+				GraphQueryService* service;
+				~Release() { service->release(); }
+			} release{this};
+			return query();
+		});
+	}
+
+
+	void release();
+
+
+	void check_handle(uint32_t handle, const char* query);
+};
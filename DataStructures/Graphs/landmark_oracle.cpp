@@ -0,0 +1,239 @@
+#include "landmark_oracle.h"
+#include "../thread_pool.h"
+#include <cmath>
+#include <future>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+
+LandmarkOracle::LandmarkOracle(Graph& graph, size_t landmarkCount, Selection selection,
+	size_t threads, unsigned seed) : graph(&graph) {
+
+	count = graph.handle_count();
+	if (!count || !landmarkCount) {
+		std::cerr << "Landmark oracle not built: Graph and landmark count must be non-empty." << std::endl;
+		throw std::invalid_argument("Graph and landmark count must be non-empty.");
+	}
+	size_t k = landmarkCount < count ? landmarkCount : count;
+	fromLandmark.assign(count * k, INFINITY);
+	toLandmark.assign(count * k, INFINITY);
+
+	ThreadPool pool(threads);
+	std::vector<std::future<void>> reverse;
+	std::vector<double> nearest(count, INFINITY), distance;
+	std::vector<uint32_t> previous;
+	std::vector<bool> chosen(count, false);
+	std::mt19937 random(seed);
+
+	for (size_t i = 0; i < k; i++) {
+		uint32_t landmark = selection == AVOID
+			? select_avoid(nearest, chosen, random)
+			: select_farthest(nearest, chosen, random);
+		landmarks.push_back(landmark);
+		chosen[landmark] = true;
+
+		reverse.push_back(pool.submit([this, landmark, i]() {
+			std::vector<double> distance;
+			std::vector<uint32_t> previous;
+			this->graph->dijsktras_algorithm(landmark, distance, previous, NULL_HANDLE, true);
+			store(i, distance, toLandmark);
+		}));
+
+		// The next selection depends on these distances, so they are computed here.
+		graph.dijsktras_algorithm(landmark, distance, previous);
+		store(i, distance, fromLandmark);
+		for (uint32_t v = 0; v < count; v++) {
+			if (distance[v] < nearest[v]) { nearest[v] = distance[v]; }
+		}
+	}
+	for (std::future<void>& task : reverse) {
+		task.get();
+	}
+}
+
+
+double LandmarkOracle::lower_bound(uint32_t handle, uint32_t goalHandle) const {
+
+	size_t k = landmarks.size();
+	const float* fromNode = &fromLandmark[handle * k], * fromGoal = &fromLandmark[goalHandle * k];
+	const float* toNode = &toLandmark[handle * k], * toGoal = &toLandmark[goalHandle * k];
+	double bound = 0;
+	for (size_t i = 0; i < k; i++) {
+		double forward = double(fromGoal[i]) - fromNode[i];
+		double backward = double(toNode[i]) - toGoal[i];
+		// A landmark that reaches the node but not the goal, or that the node reaches but the goal
+		// does not, proves there is no path.
+		if (forward == INFINITY || backward == INFINITY) { return INFINITY; }
+		forward -= ROUNDING_SLACK * (double(fromGoal[i]) + fromNode[i]);
+		backward -= ROUNDING_SLACK * (double(toNode[i]) + toGoal[i]);
+		// Terms involving a landmark that reaches neither end are NaN or -inf and never win.
+		if (forward > bound) { bound = forward; }
+		if (backward > bound) { bound = backward; }
+	}
+	return bound;
+}
+
+
+double LandmarkOracle::query(uint32_t startHandle, uint32_t goalHandle, std::vector<uint32_t>& path,
+	size_t* settled) const {
+
+	validate_tables();
+	return graph->a_star(startHandle, goalHandle, path,
+		[this, goalHandle](uint32_t handle) { return lower_bound(handle, goalHandle); }, settled);
+}
+
+
+double LandmarkOracle::query(const std::string& startId, const std::string& goalId,
+	std::vector<std::string>& path, size_t* settled) const {
+
+	validate_tables();
+	uint32_t goalHandle = graph->get_handle(goalId);
+	if (goalHandle == NULL_HANDLE) {
+		std::cerr << "Landmark query not run: Node does not exist." << std::endl;
+		throw std::invalid_argument("Node does not exist.");
+	}
+	return graph->a_star(startId, goalId, path,
+		[this, goalHandle](uint32_t handle) { return lower_bound(handle, goalHandle); }, settled);
+}
+
+
+std::string LandmarkOracle::to_string() const {
+	std::stringstream ss;
+	ss << "__LandmarkOracle__{count: " << count << ", landmarks: [";
+	for (size_t i = 0; i < landmarks.size(); i++) {
+		ss << graph->get_id(landmarks[i]);
+		if (i + 1 != landmarks.size()) { ss << ", "; }
+	}
+	ss << "]}";
+	return ss.str();
+}
+
+
+uint32_t LandmarkOracle::select_farthest(const std::vector<double>& nearest, const std::vector<bool>& chosen,
+	std::mt19937& random) const {
+
+	std::vector<double> distance;
+	std::vector<uint32_t> previous;
+	const std::vector<double>* from = &nearest;
+	if (landmarks.empty()) {
+		// Nothing to be far from yet, so start from whatever is farthest from a random node.
+		uint32_t root = std::uniform_int_distribution<uint32_t>(0, uint32_t(count - 1))(random);
+		graph->dijsktras_algorithm(root, distance, previous);
+		for (uint32_t v = 0; v < count; v++) {
+			if (distance[v] == INFINITY) { distance[v] = -INFINITY; }
+		}
+		from = &distance;
+	}
+
+	// Nodes no landmark reaches are only taken once every reachable node is a landmark, as they
+	// are usually isolated sources that would bound little else.
+	uint32_t best = NULL_HANDLE, unreached = NULL_HANDLE;
+	for (uint32_t v = 0; v < count; v++) {
+		if (chosen[v]) { continue; }
+		if (std::isinf((*from)[v])) {
+			if (unreached == NULL_HANDLE) { unreached = v; }
+		}
+		else if (best == NULL_HANDLE || (*from)[v] > (*from)[best]) {
+			best = v;
+		}
+	}
+	return best != NULL_HANDLE ? best : unreached;
+}
+
+
+uint32_t LandmarkOracle::select_avoid(const std::vector<double>& nearest, const std::vector<bool>& chosen,
+	std::mt19937& random) const {
+
+	std::uniform_int_distribution<uint32_t> pick(0, uint32_t(count - 1));
+	uint32_t root;
+	do {
+		root = pick(random);
+	} while (chosen[root]);
+	std::vector<double> distance;
+	std::vector<uint32_t> previous;
+	graph->dijsktras_algorithm(root, distance, previous);
+
+	// Flatten the shortest path tree into child lists.
+	std::vector<uint32_t> offsets(count + 1, 0), tree(count);
+	for (uint32_t v = 0; v < count; v++) {
+		if (v != root && previous[v] != NULL_HANDLE) { offsets[previous[v] + 1]++; }
+	}
+	for (uint32_t v = 0; v < count; v++) {
+		offsets[v + 1] += offsets[v];
+	}
+	std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+	for (uint32_t v = 0; v < count; v++) {
+		if (v != root && previous[v] != NULL_HANDLE) { tree[cursor[previous[v]]++] = v; }
+	}
+	std::vector<uint32_t> order(1, root);
+	for (size_t i = 0; i < order.size(); i++) {
+		for (uint32_t e = offsets[order[i]]; e < offsets[order[i] + 1]; e++) {
+			order.push_back(tree[e]);
+		}
+	}
+
+	// Weigh each node by how far its current bound from root falls short, and sum the weights
+	// bottom-up. Subtrees already holding a landmark are covered and weigh nothing. Only the
+	// forward table is read, since the reverse one is still being filled in the background.
+	size_t stride = fromLandmark.size() / count;
+	const float* fromRoot = &fromLandmark[root * stride];
+	std::vector<double> size(count, 0);
+	std::vector<bool> covered(count, false);
+	for (size_t i = order.size(); i-- > 0;) {
+		uint32_t v = order[i];
+		const float* fromNode = &fromLandmark[v * stride];
+		double bound = 0;
+		for (size_t l = 0; l < landmarks.size(); l++) {
+			double term = double(fromNode[l]) - fromRoot[l];
+			if (term > bound) { bound = term; }
+		}
+		size[v] += distance[v] > bound ? distance[v] - bound : 0;
+		if (chosen[v] || covered[v]) {
+			covered[v] = true;
+			size[v] = 0;
+		}
+		if (v != root) {
+			if (covered[v]) {
+				covered[previous[v]] = true;
+			}
+			else {
+				size[previous[v]] += size[v];
+			}
+		}
+	}
+
+	// Walk down from the root, always into the heaviest uncovered subtree, until reaching a leaf.
+	uint32_t curr = root;
+	while (true) {
+		uint32_t best = NULL_HANDLE;
+		for (uint32_t e = offsets[curr]; e < offsets[curr + 1]; e++) {
+			uint32_t child = tree[e];
+			if (covered[child]) { continue; }
+			if (best == NULL_HANDLE || size[child] > size[best]) { best = child; }
+		}
+		if (best == NULL_HANDLE) { break; }
+		curr = best;
+	}
+	// A root with nothing uncovered below it would make a useless landmark.
+	if (curr == root) {
+		return select_farthest(nearest, chosen, random);
+	}
+	return curr;
+}
+
+
+void LandmarkOracle::store(size_t slot, const std::vector<double>& distance, std::vector<float>& table) const {
+	size_t stride = table.size() / count;
+	for (uint32_t v = 0; v < count; v++) {
+		table[v * stride + slot] = float(distance[v]);
+	}
+}
+
+
+void LandmarkOracle::validate_tables() const {
+	if (graph->handle_count() != count) {
+		std::cerr << "Landmark query not run: Graph changed since the oracle was built." << std::endl;
+		throw std::invalid_argument("Graph changed since the oracle was built.");
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "graph.h"
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+/* ALT (A*, landmarks, triangle inequality) distance oracle over a weighted Graph. A handful of
+landmark nodes are chosen and the distances from and to each of them are stored for every node.
+For any landmark L, d(L,t) - d(L,v) and d(v,L) - d(t,L) are lower bounds on d(v,t), and the
+largest of them is an A* heuristic far tighter than zero on road-like graphs. The tables hold
+floats, and each bound gives up a little slack so that rounding never lets it overestimate; the
+bounds therefore never exceed the true distance, but are only consistent up to that rounding.
+Graph::a_star reopens any node it later reaches by a lighter route, so queries still return
+shortest paths.
+
+The tables are a snapshot indexed by handle: adding or removing nodes or edges, or changing
+weights, leaves them stale and the oracle must be rebuilt. */
+class LandmarkOracle {
+
+public:
+
+	enum Selection {
+		// Each landmark is the node farthest from the landmarks chosen so far.
+		FARTHEST,
+		// Goldberg and Werneck's avoid: grows a shortest path tree from a random root and picks a
+		// leaf under the subtree whose current bounds are worst and that holds no landmark yet.
+		AVOID
+	};
+
+	Graph* graph;
+	size_t count = 0;
+	std::vector<uint32_t> landmarks;
+
+	// d(landmarks[i], v) and d(v, landmarks[i]) at [v * landmarks.size() + i], INFINITY where
+	// there is no path. Stored as float to halve the footprint; bounds allow for the rounding.
+	std::vector<float> fromLandmark;
+	std::vector<float> toLandmark;
+
+protected:
+
+	// Relative slack taken off every bound so float rounding never makes it overestimate.
+	static constexpr double ROUNDING_SLACK = 1.2e-7;
+
+public:
+
+	/* Selects up to landmarkCount landmarks and fills both tables. Each landmark needs one forward
+	Dijkstra before the next can be chosen, but the reverse Dijkstras run on the thread pool while
+	selection carries on. Zero threads means one per hardware thread. */
+	LandmarkOracle(Graph& graph, size_t landmarkCount = 16, Selection selection = AVOID,
+		size_t threads = 0, unsigned seed = 1);
+
+
+	// Lower bound on d(handle, goalHandle); INFINITY when the tables prove there is no path.
+	double lower_bound(uint32_t handle, uint32_t goalHandle) const;
+
+
+	/* A* from startHandle to goalHandle guided by the landmark bounds. Fills path and returns its
+	weight, or INFINITY with an empty path. settled, if given, receives the number of nodes
+	expanded. */
+	double query(uint32_t startHandle, uint32_t goalHandle, std::vector<uint32_t>& path,
+		size_t* settled = nullptr) const;
+
+
+	double query(const std::string& startId, const std::string& goalId, std::vector<std::string>& path,
+		size_t* settled = nullptr) const;
+
+
+	std::string to_string() const;
+
+protected:
+
+	// nearest holds each node's distance from the closest landmark so far.
+	uint32_t select_farthest(const std::vector<double>& nearest, const std::vector<bool>& chosen,
+		std::mt19937& random) const;
+
+
+	uint32_t select_avoid(const std::vector<double>& nearest, const std::vector<bool>& chosen,
+		std::mt19937& random) const;
+
+
+	// Copies one Dijkstra result into column slot of table.
+	void store(size_t slot, const std::vector<double>& distance, std::vector<float>& table) const;
+
+
+	void validate_tables() const;
+};
@@ -55,6 +55,7 @@ void Tree::create_node(const std::string& id, const bool weighted) {
 	TreeNode* newGraphNode = new TreeNode(*nodeId, weighted);
 	this->ids->append(*nodeId);
 	this->nodes->put(id, *newGraphNode);
+	this->register_node(newGraphNode);
 }
 
 
@@ -89,23 +90,29 @@ void Tree::validate_graph() {
 
 
 void Tree::validate_tree() {
-	SmartList<String>* topSorted = new SmartList<String>;
-	this->topological_sort(topSorted);
-	if (topSorted->is_empty()) {
+	std::vector<uint32_t> order, levelOffsets, cycle;
+	// An empty graph has no node to root the tree at; it is reported as it always was.
+	if (!this->handle_count()) {
 		std::cerr << "Tree cannot be made; edges contain a cycle." << std::endl;
 		throw std::invalid_argument("Tree cannot be made; edges contain a cycle.");
 	}
-	else {
-		TreeNode* root = this->get_node(*topSorted->head->data);
-		SmartList<String>* dfs = new SmartList<String>;
-		this->depth_first_search(root->id.to_string(), dfs);
-		if (dfs->size != this->count) {
-			std::cerr << "Tree cannot be made, nodes aren't connected." << std::endl;
-			throw std::invalid_argument("Tree cannot be made, nodes aren't connected.");
-		}
-		else {
-			this->set_root(root);
+	else if (!this->topological_levels(order, levelOffsets, &cycle, 1)) {
+		std::stringstream ss;
+		for (uint32_t handle : cycle) {
+			ss << "<" << this->get_id(handle) << "> -> ";
 		}
+		ss << "<" << this->get_id(cycle.front()) << ">";
+		std::cerr << "Tree cannot be made; edges contain a cycle: " << ss.str() << std::endl;
+		throw std::invalid_argument("Tree cannot be made; edges contain a cycle.");
+	}
+	// In a DAG every node is reachable from some node without parents, so the tree is connected
+	// exactly when the first level holds a single node.
+	else if (levelOffsets[1] != 1) {
+		std::cerr << "Tree cannot be made, nodes aren't connected." << std::endl;
+		throw std::invalid_argument("Tree cannot be made, nodes aren't connected.");
+	}
+	else {
+		this->set_root(this->get_node(this->get_id(order.front())));
 	}
 }
 
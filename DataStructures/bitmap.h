@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+
+/* Fixed-size bit set that many threads can mark at once. */
+class AtomicBitmap {
+
+public:
+
+	size_t size;
+	size_t wordCount;
+	std::unique_ptr<std::atomic<uint64_t>[]> words;
+
+public:
+
+	AtomicBitmap(size_t size = 0) : size(size), wordCount((size + 63) / 64),
+		words(new std::atomic<uint64_t>[(size + 63) / 64]) {
+		clear();
+	}
+
+
+	bool test(size_t index) const {
+		return (words[index >> 6].load(std::memory_order_relaxed) >> (index & 63)) & 1;
+	}
+
+
+	// Returns true only for the one caller that flipped the bit from 0 to 1.
+	bool set(size_t index) {
+		uint64_t mask = uint64_t(1) << (index & 63);
+		return !(words[index >> 6].fetch_or(mask, std::memory_order_relaxed) & mask);
+	}
+
+
+	void clear() {
+		for (size_t i = 0; i < wordCount; i++) {
+			words[i].store(0, std::memory_order_relaxed);
+		}
+	}
+};
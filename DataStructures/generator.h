@@ -0,0 +1,125 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+
+/* Lazily computed sequence produced by a C++20 coroutine that co_yields values of T. Nothing
+runs until the first value is asked for, and the coroutine only runs up to its next co_yield
+each time the iterator advances, so a caller that stops early never pays for the rest. An
+exception thrown inside the coroutine comes out of begin() or operator++. Move-only; the
+coroutine is destroyed with the generator. */
+template<typename T>
+class Generator {
+
+public:
+
+	struct promise_type {
+		T current;
+		std::exception_ptr failure;
+
+		Generator get_return_object() {
+			return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+
+		std::suspend_always final_suspend() noexcept { return {}; }
+
+		std::suspend_always yield_value(T value) {
+			current = std::move(value);
+			return {};
+		}
+
+		void return_void() {}
+
+		void unhandled_exception() {
+			failure = std::current_exception();
+		}
+	};
+
+
+	class iterator {
+
+	public:
+
+		using iterator_category = std::input_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+
+		std::coroutine_handle<promise_type> coroutine;
+
+		iterator(std::coroutine_handle<promise_type> coroutine = nullptr) : coroutine(coroutine) {}
+
+		const T& operator*() const {
+			return coroutine.promise().current;
+		}
+
+		iterator& operator++() {
+			Generator::resume(coroutine);
+			return *this;
+		}
+
+		void operator++(int) {
+			++*this;
+		}
+
+		bool operator==(std::default_sentinel_t) const {
+			return !coroutine || coroutine.done();
+		}
+	};
+
+protected:
+
+	std::coroutine_handle<promise_type> coroutine;
+
+public:
+
+	explicit Generator(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+
+	Generator(Generator&& other) noexcept : coroutine(std::exchange(other.coroutine, nullptr)) {}
+
+
+	Generator& operator=(Generator&& other) noexcept {
+		if (this != &other) {
+			if (coroutine) { coroutine.destroy(); }
+			coroutine = std::exchange(other.coroutine, nullptr);
+		}
+		return *this;
+	}
+
+
+	Generator(const Generator&) = delete;
+
+
+	Generator& operator=(const Generator&) = delete;
+
+
+	~Generator() {
+		if (coroutine) { coroutine.destroy(); }
+	}
+
+
+	// Runs the coroutine to its first value. Call once; the sequence cannot be restarted.
+	iterator begin() {
+		resume(coroutine);
+		return iterator(coroutine);
+	}
+
+
+	std::default_sentinel_t end() const {
+		return std::default_sentinel;
+	}
+
+protected:
+
+	static void resume(std::coroutine_handle<promise_type> coroutine) {
+		if (!coroutine || coroutine.done()) { return; }
+		coroutine.resume();
+		if (coroutine.promise().failure) {
+			std::rethrow_exception(std::exchange(coroutine.promise().failure, nullptr));
+		}
+	}
+};
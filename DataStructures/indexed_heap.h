@@ -0,0 +1,136 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+
+/* Flat D-ary min-heap over the dense items [0, capacity), keyed by double, with decrease-key.
+Each item's slot in the heap is tracked so a key can be lowered in place. */
+template<size_t D = 4>
+class IndexedHeap {
+
+public:
+
+	static constexpr uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+	std::vector<uint32_t> heap;
+	std::vector<double> keys;
+	std::vector<uint32_t> positions;
+
+public:
+
+	IndexedHeap(size_t capacity = 0) : keys(capacity), positions(capacity, NOT_IN_HEAP) {}
+
+
+	bool is_empty() const {
+		return heap.empty();
+	}
+
+
+	size_t size() const {
+		return heap.size();
+	}
+
+
+	bool contains(uint32_t item) const {
+		return positions[item] != NOT_IN_HEAP;
+	}
+
+
+	double top_key() const {
+		return keys[heap[0]];
+	}
+
+
+	void push(uint32_t item, double key) {
+		keys[item] = key;
+		positions[item] = static_cast<uint32_t>(heap.size());
+		heap.push_back(item);
+		sift_up(positions[item]);
+	}
+
+
+	// Only lowers the key; a larger key is ignored.
+	void decrease_key(uint32_t item, double key) {
+		if (key >= keys[item]) { return; }
+		keys[item] = key;
+		sift_up(positions[item]);
+	}
+
+
+	void push_or_decrease(uint32_t item, double key) {
+		if (contains(item)) {
+			decrease_key(item, key);
+		}
+		else {
+			push(item, key);
+		}
+	}
+
+
+	uint32_t pop() {
+		uint32_t top = heap[0];
+		positions[top] = NOT_IN_HEAP;
+		uint32_t last = heap.back();
+		heap.pop_back();
+		if (!heap.empty()) {
+			heap[0] = last;
+			positions[last] = 0;
+			sift_down(0);
+		}
+		return top;
+	}
+
+
+	// Changes the item range to [0, capacity). Items at or past the new capacity must not be queued.
+	void resize(size_t capacity) {
+		keys.resize(capacity);
+		positions.resize(capacity, NOT_IN_HEAP);
+	}
+
+
+	// Empties the heap in O(size) rather than O(capacity).
+	void clear() {
+		for (uint32_t item : heap) {
+			positions[item] = NOT_IN_HEAP;
+		}
+		heap.clear();
+	}
+
+protected:
+
+	void sift_up(size_t slot) {
+		uint32_t item = heap[slot];
+		double key = keys[item];
+		while (slot > 0) {
+			size_t parent = (slot - 1) / D;
+			if (keys[heap[parent]] <= key) { break; }
+			heap[slot] = heap[parent];
+			positions[heap[slot]] = static_cast<uint32_t>(slot);
+			slot = parent;
+		}
+		heap[slot] = item;
+		positions[item] = static_cast<uint32_t>(slot);
+	}
+
+
+	void sift_down(size_t slot) {
+		uint32_t item = heap[slot];
+		double key = keys[item];
+		size_t count = heap.size();
+		while (true) {
+			size_t first = slot * D + 1;
+			if (first >= count) { break; }
+			size_t last = first + D < count ? first + D : count;
+			size_t best = first;
+			for (size_t child = first + 1; child < last; child++) {
+				if (keys[heap[child]] < keys[heap[best]]) { best = child; }
+			}
+			if (keys[heap[best]] >= key) { break; }
+			heap[slot] = heap[best];
+			positions[heap[slot]] = static_cast<uint32_t>(slot);
+			slot = best;
+		}
+		heap[slot] = item;
+		positions[item] = static_cast<uint32_t>(slot);
+	}
+};
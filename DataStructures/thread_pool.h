@@ -0,0 +1,132 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <exception>
+
+
+class ThreadPool {
+
+public:
+
+	size_t size;
+
+protected:
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex lock;
+	std::condition_variable ready;
+	bool stopping = false;
+
+public:
+
+	// Zero threads means one per hardware thread.
+	ThreadPool(size_t threads = 0) {
+
+		size = threads ? threads : std::thread::hardware_concurrency();
+		if (!size) { size = 1; }
+		for (size_t i = 0; i < size; i++) {
+			workers.emplace_back([this]() { work(); });
+		}
+	}
+
+
+	~ThreadPool() {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			stopping = true;
+		}
+		ready.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+
+	template<typename F>
+	auto submit(F task) -> std::future<decltype(task())> {
+
+		typedef decltype(task()) resultType;
+		std::shared_ptr<std::packaged_task<resultType()>> packaged = \
+			std::make_shared<std::packaged_task<resultType()>>(std::move(task));
+		std::future<resultType> result = packaged->get_future();
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			tasks.emplace([packaged]() { (*packaged)(); });
+		}
+		ready.notify_one();
+		return result;
+	}
+
+
+	/* Runs body(chunkBegin, chunkEnd, worker) over [begin, end) in chunks of grain, handing chunks
+	out dynamically so uneven work balances itself. worker is in [0, size) and can index per-thread
+	scratch space. Blocks until every chunk is done. If body throws, no more chunks are started,
+	and the first exception is rethrown once the chunks already running have returned. Must not
+	be called from inside the pool. */
+	template<typename F>
+	void parallel_for(size_t begin, size_t end, F body, size_t grain = 0) {
+
+		if (begin >= end) { return; }
+		size_t total = end - begin;
+		if (!grain) {
+			grain = total / (size * 8);
+			if (grain < 64) { grain = 64; }
+		}
+		if (size == 1 || total <= grain) {
+			body(begin, end, 0);
+			return;
+		}
+
+		std::atomic<size_t> next(begin);
+		std::exception_ptr failure;
+		std::mutex failureLock;
+		std::vector<std::future<void>> running;
+		for (size_t w = 0; w < size; w++) {
+			running.push_back(submit([&next, &body, &failure, &failureLock, end, grain, w]() {
+				try {
+					while (true) {
+						size_t chunkBegin = next.fetch_add(grain);
+						if (chunkBegin >= end) { return; }
+						size_t chunkEnd = chunkBegin + grain < end ? chunkBegin + grain : end;
+						body(chunkBegin, chunkEnd, w);
+					}
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> guard(failureLock);
+					if (!failure) { failure = std::current_exception(); }
+					// No further chunks are handed out.
+					next.store(end);
+				}
+			}));
+		}
+		// Every task references this frame, so all of them must finish before it unwinds.
+		for (std::future<void>& task : running) {
+			task.wait();
+		}
+		if (failure) { std::rethrow_exception(failure); }
+	}
+
+protected:
+
+	void work() {
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				ready.wait(guard, [this]() { return stopping || !tasks.empty(); });
+				if (stopping && tasks.empty()) { return; }
+				task = std::move(tasks.front());
+				tasks.pop();
+			}
+			task();
+		}
+	}
+};